@@ -12,7 +12,10 @@
 
 #include <SDL_image.h>
 
+#include <algorithm>
+#include <chrono>
 #include <span>
+#include <thread>
 
 #include "abcgException.hpp"
 #include "abcgWindow.hpp"
@@ -146,13 +149,61 @@ std::string const &abcg::Application::getBasePath() noexcept {
 }
 
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) const {
+  pollEvents(done);
+  m_window->templatePaint();
+#if !defined(__EMSCRIPTEN__)
+  sampleInputUntilNextFrame(done);
+#endif
+}
+
+void abcg::Application::pollEvents([[maybe_unused]] bool &done) const {
   SDL_Event event{};
   while (SDL_PollEvent(&event) != 0) {
+    // Stamped before anything else, for input latency measurements
+    m_window->m_eventTime = std::chrono::steady_clock::now();
 #if !defined(__EMSCRIPTEN__)
     if (event.type == SDL_QUIT)
       done = true;
 #endif
     m_window->templateHandleEvent(event, done);
   }
-  m_window->templatePaint();
 }
+
+#if !defined(__EMSCRIPTEN__)
+// SDL events can only be pumped by the thread that created the window, so the
+// input is sampled here, on the main thread, while waiting for the next frame
+// (see abcg::WindowSettings::inputSamplingRate)
+void abcg::Application::sampleInputUntilNextFrame(bool &done) const {
+  auto const samplingRate{m_window->getWindowSettings().inputSamplingRate};
+  if (samplingRate <= 0)
+    return;
+
+  // Frames are paced at the refresh rate of the display
+  int refreshRate{60};
+  if (SDL_DisplayMode mode{};
+      SDL_GetWindowDisplayMode(m_window->getSDLWindow(), &mode) == 0 &&
+      mode.refresh_rate > 0) {
+    refreshRate = mode.refresh_rate;
+  }
+
+  using Clock = std::chrono::steady_clock;
+  auto const toDuration{[](int rate) {
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / rate));
+  }};
+  auto const framePeriod{toDuration(refreshRate)};
+  auto const samplePeriod{toDuration(samplingRate)};
+
+  // If the frame took longer than the period, the next one starts right away
+  auto &nextFrame{m_window->m_nextFrameTime};
+  nextFrame = std::max(nextFrame + framePeriod, Clock::now());
+
+  while (!done) {
+    auto const now{Clock::now()};
+    if (now >= nextFrame)
+      break;
+    std::this_thread::sleep_until(std::min(now + samplePeriod, nextFrame));
+    pollEvents(done);
+  }
+}
+#endif
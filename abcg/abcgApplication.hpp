@@ -45,6 +45,10 @@ public:
 
 private:
   void mainLoopIterator(bool &done) const;
+  void pollEvents(bool &done) const;
+#if !defined(__EMSCRIPTEN__)
+  void sampleInputUntilNextFrame(bool &done) const;
+#endif
 
   Window *m_window{};
 
@@ -15,7 +15,10 @@
 
 #include "abcg.hpp"
 #include "abcgOpenGLImage.hpp"
+#include "abcgOpenGLParticles.hpp"
 #include "abcgOpenGLShader.hpp"
+#include "abcgOpenGLFrameTimer.hpp"
+#include "abcgOpenGLStreamBuffer.hpp"
 #include "abcgOpenGLWindow.hpp"
 
 #endif
@@ -0,0 +1,180 @@
+/**
+ * @file abcgOpenGLFrameTimer.cpp
+ * @brief Definition of abcg::OpenGLFrameTimer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#include "abcgOpenGLFrameTimer.hpp"
+
+#include <algorithm>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+/**
+ * @brief Prepares the timer for a new OpenGL context.
+ *
+ * @param vSync Whether the swaps are synchronized with the vertical retrace
+ * (abcg::OpenGLSettings::vSync).
+ * @param refreshRate Refresh rate of the display, in Hz, used until it is
+ * measured from the swaps. If not positive, 60 Hz is assumed.
+ */
+void abcg::OpenGLFrameTimer::create(bool vSync, int refreshRate) {
+  destroy();
+  m_vSync = vSync;
+  auto const rate{refreshRate > 0 ? refreshRate : 60};
+  m_period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / rate));
+}
+
+/**
+ * @brief Releases the pending fences and clears the measured frames.
+ */
+void abcg::OpenGLFrameTimer::destroy() {
+  for (auto const &pending : m_pending) {
+    abcg::glDeleteSync(pending.sync);
+  }
+  m_pending.clear();
+  m_history.clear();
+  m_lastSwap.reset();
+  m_frame = 0;
+}
+
+/**
+ * @brief Checks, without waiting, which of the pending frames were finished
+ * by the GPU.
+ *
+ * Called by abcg::OpenGLWindow at the beginning of each frame and by
+ * abcg::OpenGLFrameTimer::afterSwap.
+ *
+ * @throw abcg::RuntimeError if a fence cannot be queried.
+ */
+void abcg::OpenGLFrameTimer::poll() {
+  auto const now{Clock::now()};
+  // The GPU finishes the frames in order: the first unsignaled fence ends
+  // the search
+  while (!m_pending.empty()) {
+    auto &pending{m_pending.front()};
+    auto const status{abcg::glClientWaitSync(pending.sync, 0, 0)};
+    if (status == GL_WAIT_FAILED)
+      throw abcg::RuntimeError("Failed to query frame fence");
+    if (status == GL_TIMEOUT_EXPIRED) {
+      for (auto &later : m_pending) {
+        later.lastUnsignaled = now;
+      }
+      return;
+    }
+    resolve(pending, now);
+    abcg::glDeleteSync(pending.sync);
+    m_pending.pop_front();
+  }
+}
+
+/**
+ * @brief Inserts the fence of the current frame.
+ *
+ * Called by abcg::OpenGLWindow after the commands of the frame, just before
+ * `SDL_GL_SwapWindow`.
+ */
+void abcg::OpenGLFrameTimer::beforeSwap() {
+  // A GPU that falls this far behind is not measured: the oldest frames are
+  // dropped instead of growing the queue
+  if (m_pending.size() >= historySize) {
+    abcg::glDeleteSync(m_pending.front().sync);
+    m_pending.pop_front();
+  }
+
+  auto const now{Clock::now()};
+  m_pending.push_back(
+      {.frame = m_frame,
+       .sync = abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+       .swapRequested = now,
+       .lastUnsignaled = now});
+}
+
+/**
+ * @brief Measures the swap interval and starts the next frame.
+ *
+ * Called by abcg::OpenGLWindow just after `SDL_GL_SwapWindow` returns.
+ */
+void abcg::OpenGLFrameTimer::afterSwap() {
+  auto const now{Clock::now()};
+  if (m_vSync && m_lastSwap) {
+    // Intervals far from the period are missed retraces or stalls, and are
+    // not part of the average
+    auto const interval{now - *m_lastSwap};
+    if (interval > m_period / 2 && interval < m_period * 3 / 2)
+      m_period += (interval - m_period) / 16;
+  }
+  m_lastSwap = now;
+  ++m_frame;
+  poll();
+}
+
+/**
+ * @brief Returns the number of the frame being painted.
+ *
+ * The number starts at zero and is incremented after each swap.
+ */
+std::uint64_t abcg::OpenGLFrameTimer::getFrameNumber() const noexcept {
+  return m_frame;
+}
+
+/**
+ * @brief Returns the timing of a frame.
+ *
+ * @param frame Number of the frame, as returned by
+ * abcg::OpenGLFrameTimer::getFrameNumber while it was painted.
+ *
+ * @returns Timing of the frame, or an empty optional if the frame was not
+ * finished by the GPU yet, or if it is older than the last
+ * abcg::OpenGLFrameTimer::historySize frames.
+ */
+std::optional<abcg::OpenGLFrameTiming>
+abcg::OpenGLFrameTimer::getTiming(std::uint64_t frame) const {
+  auto const timing{std::find_if(m_history.begin(), m_history.end(),
+                                 [frame](OpenGLFrameTiming const &other) {
+                                   return other.frame == frame;
+                                 })};
+  if (timing == m_history.end())
+    return std::nullopt;
+  return *timing;
+}
+
+/**
+ * @brief Returns the estimated refresh period of the display.
+ */
+abcg::OpenGLFrameTimer::Clock::duration
+abcg::OpenGLFrameTimer::getRefreshPeriod() const noexcept {
+  return m_period;
+}
+
+// With vertical synchronization, the frame is displayed at the first retrace
+// of the grid after the GPU finished it
+void abcg::OpenGLFrameTimer::resolve(PendingFrame const &pending,
+                                     Clock::time_point now) {
+  OpenGLFrameTiming timing{
+      .frame = pending.frame,
+      .swapRequested = pending.swapRequested,
+      .completedAfter = std::max(pending.swapRequested, pending.lastUnsignaled),
+      .completedBy = now,
+      .displayed = {}};
+
+  if (m_vSync && m_lastSwap) {
+    auto const offset{(timing.completedAfter - *m_lastSwap).count()};
+    auto const period{m_period.count()};
+    auto const retraces{offset > 0 ? (offset + period - 1) / period
+                                   : -(-offset / period)};
+    timing.displayed = *m_lastSwap + retraces * m_period;
+  } else {
+    timing.displayed = timing.completedAfter +
+                       (timing.completedBy - timing.completedAfter) / 2;
+  }
+
+  m_history.push_back(timing);
+  if (m_history.size() > historySize)
+    m_history.pop_front();
+}
@@ -0,0 +1,117 @@
+/**
+ * @file abcgOpenGLFrameTimer.hpp
+ * @brief Header file of abcg::OpenGLFrameTimer.
+ *
+ * Declaration of abcg::OpenGLFrameTimer class.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_FRAME_TIMER_HPP_
+#define ABCG_OPENGL_FRAME_TIMER_HPP_
+
+#include "abcgOpenGLExternal.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace abcg {
+struct OpenGLFrameTiming;
+class OpenGLFrameTimer;
+} // namespace abcg
+
+/**
+ * @brief Timing of a frame measured by abcg::OpenGLFrameTimer.
+ */
+struct abcg::OpenGLFrameTiming {
+  /** @brief Number of the frame, as returned by
+   * abcg::OpenGLFrameTimer::getFrameNumber while it was painted. */
+  std::uint64_t frame{};
+  /** @brief Time at which the swap of the frame was requested. */
+  std::chrono::steady_clock::time_point swapRequested{};
+  /** @brief Lower bound of the time at which the GPU finished the commands
+   * of the frame: the last poll at which its fence was not signaled, or
+   * swapRequested. */
+  std::chrono::steady_clock::time_point completedAfter{};
+  /** @brief Upper bound of the time at which the GPU finished the commands
+   * of the frame: the first poll at which its fence was signaled. */
+  std::chrono::steady_clock::time_point completedBy{};
+  /** @brief Estimated time at which the frame started to be displayed. */
+  std::chrono::steady_clock::time_point displayed{};
+};
+
+/**
+ * @brief Estimates when each frame of an abcg::OpenGLWindow is displayed.
+ *
+ * `SDL_GL_SwapWindow` only queues the frame: the GPU may still be executing
+ * its commands, and the frame is displayed later, at a vertical retrace.
+ * The timer inserts a fence (`glFenceSync`) before each swap and polls the
+ * pending fences with a zero timeout at the beginning of each frame and
+ * after each swap, so it never stalls the rendering loop. A signaled fence
+ * bounds the time at which the GPU finished the frame.
+ *
+ * With vertical synchronization, the frame is displayed at the first
+ * retrace after it is finished. The retraces are placed on a grid anchored
+ * at the return of the latest swap (which blocks until a retrace) with the
+ * refresh period smoothed from the intervals between swaps, starting from
+ * the refresh rate of the display. Without vertical synchronization, the
+ * frame is displayed as soon as it is finished, and the estimate is the
+ * middle of the completion interval.
+ *
+ * The estimate does not include the latency added by a compositor or by the
+ * display itself.
+ *
+ * @remark The fences are released by abcg::OpenGLFrameTimer::destroy, which
+ * must be called while the OpenGL context is current.
+ */
+class abcg::OpenGLFrameTimer {
+public:
+  /** @brief Clock of the time points, the same of
+   * abcg::Window::getEventTime. */
+  using Clock = std::chrono::steady_clock;
+
+  /** @brief Number of resolved frames kept for
+   * abcg::OpenGLFrameTimer::getTiming. */
+  static constexpr std::size_t historySize{64};
+
+  OpenGLFrameTimer() = default;
+  OpenGLFrameTimer(OpenGLFrameTimer const &) = delete;
+  OpenGLFrameTimer &operator=(OpenGLFrameTimer const &) = delete;
+
+  void create(bool vSync, int refreshRate);
+  void destroy();
+
+  void poll();
+  void beforeSwap();
+  void afterSwap();
+
+  [[nodiscard]] std::uint64_t getFrameNumber() const noexcept;
+  [[nodiscard]] std::optional<OpenGLFrameTiming>
+  getTiming(std::uint64_t frame) const;
+  [[nodiscard]] Clock::duration getRefreshPeriod() const noexcept;
+
+private:
+  struct PendingFrame {
+    std::uint64_t frame{};
+    GLsync sync{};
+    Clock::time_point swapRequested{};
+    Clock::time_point lastUnsignaled{};
+  };
+
+  bool m_vSync{};
+  Clock::duration m_period{};
+  std::optional<Clock::time_point> m_lastSwap;
+
+  std::uint64_t m_frame{};
+  std::deque<PendingFrame> m_pending;
+  std::deque<OpenGLFrameTiming> m_history;
+
+  void resolve(PendingFrame const &pending, Clock::time_point now);
+};
+
+#endif
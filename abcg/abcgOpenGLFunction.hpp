@@ -1471,6 +1471,14 @@ inline void glTexImage2DMultisample(
          internalformat, width, height, fixedsamplelocations);
 }
 
+// OpenGL 4.4+ function definitions (ARB_buffer_storage)
+
+inline void glBufferStorage(
+    GLenum target, GLsizeiptr size, void const *data, GLbitfield flags,
+    source_location const &sourceLocation = source_location::current()) {
+  callGL(sourceLocation, ::glBufferStorage, target, size, data, flags);
+}
+
 // OpenGL 2.0+ function definitions
 
 inline void glGetDoublev(
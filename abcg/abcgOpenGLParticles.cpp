@@ -0,0 +1,399 @@
+/**
+ * @file abcgOpenGLParticles.cpp
+ * @brief Definition of abcg::OpenGLParticleSystem members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#include "abcgOpenGLParticles.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+#include "abcgOpenGLShader.hpp"
+
+namespace {
+// Layout of a particle in the vertex buffers. Must match the attributes of
+// the shaders and the order of the transform feedback varyings
+struct Particle {
+  glm::vec2 position{};
+  glm::vec2 velocity{};
+  // Remaining and total lifetime, in seconds
+  glm::vec2 life{};
+  glm::vec4 color{};
+};
+
+// Vertex shader of the update pass. Each invocation reads one particle and
+// writes it back, updated, with transform feedback. A particle whose slot
+// belongs to a burst of this update is respawned at the burst origin
+char const *const updateVertexShader{R"gl(
+  layout(location = 0) in vec2 inPosition;
+  layout(location = 1) in vec2 inVelocity;
+  layout(location = 2) in vec2 inLife;
+  layout(location = 3) in vec4 inColor;
+
+  uniform float deltaTime;
+  uniform vec2 gravity;
+  uniform float drag;
+  uniform uint capacity;
+  uniform uint seed;
+
+  uniform int burstCount;
+  uniform vec4 burstShape[MAX_BURSTS];     // position.xy, speed, lifetime
+  uniform vec4 burstDirection[MAX_BURSTS]; // direction.xy, spread
+  uniform vec4 burstColor[MAX_BURSTS];
+  uniform uvec2 burstRange[MAX_BURSTS];    // first slot, count
+
+  out vec2 outPosition;
+  out vec2 outVelocity;
+  out vec2 outLife;
+  out vec4 outColor;
+
+  // PCG hash
+  uint hash(uint value) {
+    uint state = value * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+  }
+
+  float random(inout uint state) {
+    state = hash(state);
+    return float(state) / 4294967295.0;
+  }
+
+  void main() {
+    outPosition = inPosition;
+    outVelocity = inVelocity;
+    outLife = inLife;
+    outColor = inColor;
+
+    uint slot = uint(gl_VertexID);
+    for (int i = 0; i < burstCount; ++i) {
+      if ((slot + capacity - burstRange[i].x) % capacity >= burstRange[i].y)
+        continue;
+
+      uint state = hash(slot ^ seed);
+      vec2 direction = burstDirection[i].xy;
+      float angle = atan(direction.y, direction.x) +
+                    (random(state) - 0.5) * burstDirection[i].z;
+      float speed = burstShape[i].z * (0.5 + 0.5 * random(state));
+      outPosition = burstShape[i].xy;
+      outVelocity = vec2(cos(angle), sin(angle)) * speed;
+      outLife = vec2(burstShape[i].w);
+      outColor = burstColor[i];
+    }
+
+    if (outLife.x > 0.0) {
+      outVelocity += gravity * deltaTime;
+      outVelocity *= max(1.0 - drag * deltaTime, 0.0);
+      outPosition += outVelocity * deltaTime;
+      outLife.x -= deltaTime;
+    }
+  }
+)gl"};
+
+// Dead particles are moved outside the clip volume
+char const *const renderVertexShader{R"gl(
+  layout(location = 0) in vec2 inPosition;
+  layout(location = 2) in vec2 inLife;
+  layout(location = 3) in vec4 inColor;
+
+  uniform mat4 transform;
+  uniform float pointSize;
+
+  out vec4 fragColor;
+
+  void main() {
+    gl_PointSize = pointSize;
+    if (inLife.x <= 0.0) {
+      fragColor = vec4(0.0);
+      gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+      return;
+    }
+    fragColor = vec4(inColor.rgb, inColor.a * inLife.x / inLife.y);
+    gl_Position = transform * vec4(inPosition, 0.0, 1.0);
+  }
+)gl"};
+
+// Round point with a soft edge
+char const *const renderFragmentShader{R"gl(
+  precision mediump float;
+
+  in vec4 fragColor;
+
+  out vec4 outColor;
+
+  void main() {
+    float centerDistance = length(gl_PointCoord - 0.5) * 2.0;
+    float coverage = 1.0 - smoothstep(0.5, 1.0, centerDistance);
+    outColor = vec4(fragColor.rgb, fragColor.a * coverage);
+  }
+)gl"};
+
+[[nodiscard]] std::string withHeader(char const *source) {
+  return fmt::format("#version 300 es\n#define MAX_BURSTS {}\n{}",
+                     abcg::OpenGLParticleSystem::maxBurstsPerUpdate, source);
+}
+} // namespace
+
+/**
+ * @brief Creates the shaders and the buffers of the particle system.
+ *
+ * All particles start dead.
+ *
+ * @param createInfo Configuration settings of the particle system.
+ *
+ * @throw abcg::RuntimeError if the capacity is zero or if the shaders could
+ * not be built.
+ */
+void abcg::OpenGLParticleSystem::create(
+    OpenGLParticleSystemCreateInfo const &createInfo) {
+  destroy();
+
+  if (createInfo.capacity == 0)
+    throw abcg::RuntimeError("Particle system capacity must be positive");
+
+  m_capacity = createInfo.capacity;
+  m_gravity = createInfo.gravity;
+  m_drag = createInfo.drag;
+  m_pointSize = createInfo.pointSize;
+
+  auto const updateSource{withHeader(updateVertexShader)};
+  // A fragment shader is still required to link the program, even though
+  // rasterization is disabled in the update pass
+  auto const discardSource{withHeader(R"gl(
+    precision mediump float;
+    out vec4 outColor;
+    void main() { outColor = vec4(0.0); }
+  )gl")};
+  m_updateProgram = createOpenGLTransformFeedbackProgram(
+      {{.source = updateSource, .stage = ShaderStage::Vertex},
+       {.source = discardSource, .stage = ShaderStage::Fragment}},
+      {"outPosition", "outVelocity", "outLife", "outColor"});
+
+  auto const renderVertexSource{withHeader(renderVertexShader)};
+  auto const renderFragmentSource{withHeader(renderFragmentShader)};
+  m_renderProgram = createOpenGLProgram(
+      {{.source = renderVertexSource, .stage = ShaderStage::Vertex},
+       {.source = renderFragmentSource, .stage = ShaderStage::Fragment}});
+
+  auto const updateLocation{[this](char const *name) {
+    return glGetUniformLocation(m_updateProgram, name);
+  }};
+  m_updateLocations = {.deltaTime = updateLocation("deltaTime"),
+                       .gravity = updateLocation("gravity"),
+                       .drag = updateLocation("drag"),
+                       .capacity = updateLocation("capacity"),
+                       .seed = updateLocation("seed"),
+                       .burstCount = updateLocation("burstCount"),
+                       .burstShape = updateLocation("burstShape"),
+                       .burstDirection = updateLocation("burstDirection"),
+                       .burstColor = updateLocation("burstColor"),
+                       .burstRange = updateLocation("burstRange")};
+  m_transformLocation = glGetUniformLocation(m_renderProgram, "transform");
+  m_pointSizeLocation = glGetUniformLocation(m_renderProgram, "pointSize");
+
+  // Zero-initialized particles have no remaining life
+  std::vector<Particle> const particles(m_capacity);
+  auto const size{
+      gsl::narrow<GLsizeiptr>(particles.size() * sizeof(Particle))};
+
+  glGenBuffers(2, m_VBOs.data());
+  glGenVertexArrays(2, m_VAOs.data());
+  for (auto const index : iter::range(m_VBOs.size())) {
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBOs.at(index));
+    glBufferData(GL_ARRAY_BUFFER, size, particles.data(), GL_STREAM_COPY);
+
+    glBindVertexArray(m_VAOs.at(index));
+    auto const attribute{[](GLuint location, GLint components,
+                            std::size_t offset) {
+      glVertexAttribPointer(location, components, GL_FLOAT, GL_FALSE,
+                            sizeof(Particle),
+                            reinterpret_cast<void const *>(offset));
+      glEnableVertexAttribArray(location);
+    }};
+    attribute(0, 2, offsetof(Particle, position));
+    attribute(1, 2, offsetof(Particle, velocity));
+    attribute(2, 2, offsetof(Particle, life));
+    attribute(3, 4, offsetof(Particle, color));
+  }
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  m_source = 0;
+  m_nextSlot = 0;
+  m_timeToIdle = 0.0f;
+  m_bursts.clear();
+  m_bursts.reserve(maxBurstsPerUpdate);
+}
+
+/**
+ * @brief Releases the OpenGL resources of the particle system.
+ */
+void abcg::OpenGLParticleSystem::destroy() {
+  if (m_updateProgram != 0)
+    glDeleteProgram(m_updateProgram);
+  if (m_renderProgram != 0)
+    glDeleteProgram(m_renderProgram);
+  if (m_VAOs.front() != 0)
+    glDeleteVertexArrays(2, m_VAOs.data());
+  if (m_VBOs.front() != 0)
+    glDeleteBuffers(2, m_VBOs.data());
+  m_updateProgram = 0;
+  m_renderProgram = 0;
+  m_VAOs = {};
+  m_VBOs = {};
+  m_capacity = 0;
+  m_bursts.clear();
+  m_timeToIdle = 0.0f;
+}
+
+/**
+ * @brief Queues a burst of particles to be spawned in the next update.
+ *
+ * Only the burst parameters are stored; the particles themselves are created
+ * by the GPU. Bursts beyond abcg::OpenGLParticleSystem::maxBurstsPerUpdate in
+ * the same update are dropped.
+ *
+ * @param burst Burst parameters.
+ */
+void abcg::OpenGLParticleSystem::emit(ParticleBurst const &burst) {
+  if (m_capacity == 0 || burst.count == 0 ||
+      m_bursts.size() >= maxBurstsPerUpdate)
+    return;
+
+  m_bursts.push_back(burst);
+  m_bursts.back().count = std::min(burst.count, m_capacity);
+  m_timeToIdle = std::max(m_timeToIdle, burst.lifetime);
+}
+
+/**
+ * @brief Spawns the queued bursts and advances all particles.
+ *
+ * Runs a single draw call with rasterization disabled, capturing the output
+ * with transform feedback. Does nothing while there are no live particles.
+ *
+ * @param deltaTime Elapsed time, in seconds.
+ */
+void abcg::OpenGLParticleSystem::update(float deltaTime) {
+  if (isIdle())
+    return;
+
+  std::array<glm::vec4, maxBurstsPerUpdate> shapes{};
+  std::array<glm::vec4, maxBurstsPerUpdate> directions{};
+  std::array<glm::vec4, maxBurstsPerUpdate> colors{};
+  std::array<glm::uvec2, maxBurstsPerUpdate> ranges{};
+  for (auto const index : iter::range(m_bursts.size())) {
+    auto const &burst{m_bursts.at(index)};
+    shapes.at(index) = {burst.position, burst.speed, burst.lifetime};
+    directions.at(index) = {burst.direction, burst.spread, 0.0f};
+    colors.at(index) = burst.color;
+    ranges.at(index) = {gsl::narrow<GLuint>(m_nextSlot),
+                        gsl::narrow<GLuint>(burst.count)};
+    m_nextSlot = (m_nextSlot + burst.count) % m_capacity;
+  }
+
+  auto const burstCount{gsl::narrow<GLsizei>(m_bursts.size())};
+  auto const &locations{m_updateLocations};
+  glUseProgram(m_updateProgram);
+  glUniform1f(locations.deltaTime, deltaTime);
+  glUniform2fv(locations.gravity, 1, glm::value_ptr(m_gravity));
+  glUniform1f(locations.drag, m_drag);
+  glUniform1ui(locations.capacity, gsl::narrow<GLuint>(m_capacity));
+  glUniform1ui(locations.seed, m_seed++);
+  glUniform1i(locations.burstCount, burstCount);
+  if (burstCount > 0) {
+    glUniform4fv(locations.burstShape, burstCount,
+                 glm::value_ptr(shapes.front()));
+    glUniform4fv(locations.burstDirection, burstCount,
+                 glm::value_ptr(directions.front()));
+    glUniform4fv(locations.burstColor, burstCount,
+                 glm::value_ptr(colors.front()));
+    glUniform2uiv(locations.burstRange, burstCount,
+                  glm::value_ptr(ranges.front()));
+  }
+  m_bursts.clear();
+
+  auto const target{1 - m_source};
+  glBindVertexArray(m_VAOs.at(m_source));
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, m_VBOs.at(target));
+
+  glEnable(GL_RASTERIZER_DISCARD);
+  glBeginTransformFeedback(GL_POINTS);
+  glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(m_capacity));
+  glEndTransformFeedback();
+  glDisable(GL_RASTERIZER_DISCARD);
+
+  // The buffer cannot be bound for transform feedback while it is read as a
+  // vertex buffer in the next pass
+  glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+  glBindVertexArray(0);
+  glUseProgram(0);
+
+  m_source = target;
+  m_timeToIdle = std::max(m_timeToIdle - deltaTime, 0.0f);
+}
+
+/**
+ * @brief Draws all particles as points with a single draw call.
+ *
+ * Particles are blended additively. Blending is disabled on return. Does
+ * nothing while there are no live particles.
+ */
+void abcg::OpenGLParticleSystem::render() const {
+  if (isIdle())
+    return;
+
+#if !defined(__EMSCRIPTEN__)
+  // Always enabled in OpenGL ES
+  glEnable(GL_PROGRAM_POINT_SIZE);
+#endif
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+
+  glUseProgram(m_renderProgram);
+  glUniformMatrix4fv(m_transformLocation, 1, GL_FALSE,
+                     glm::value_ptr(m_transform));
+  glUniform1f(m_pointSizeLocation, m_pointSize);
+  glBindVertexArray(m_VAOs.at(m_source));
+  glDrawArrays(GL_POINTS, 0, gsl::narrow<GLsizei>(m_capacity));
+  glBindVertexArray(0);
+  glUseProgram(0);
+
+  glDisable(GL_BLEND);
+}
+
+/**
+ * @brief Sets the matrix that transforms particle positions to clip space.
+ *
+ * @param transform Transformation matrix.
+ */
+void abcg::OpenGLParticleSystem::setTransform(
+    glm::mat4 const &transform) noexcept {
+  m_transform = transform;
+}
+
+/**
+ * @brief Returns the maximum number of live particles.
+ *
+ * @return Capacity given at creation, or 0 if the system was not created.
+ */
+std::size_t abcg::OpenGLParticleSystem::getCapacity() const noexcept {
+  return m_capacity;
+}
+
+/**
+ * @brief Returns whether there are no live particles and no pending bursts.
+ *
+ * @return Whether update and render would do nothing.
+ */
+bool abcg::OpenGLParticleSystem::isIdle() const noexcept {
+  return m_timeToIdle <= 0.0f && m_bursts.empty();
+}
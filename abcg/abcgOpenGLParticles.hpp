@@ -0,0 +1,157 @@
+/**
+ * @file abcgOpenGLParticles.hpp
+ * @brief Header file of abcg::OpenGLParticleSystem.
+ *
+ * Declaration of abcg::OpenGLParticleSystem class.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_PARTICLES_HPP_
+#define ABCG_OPENGL_PARTICLES_HPP_
+
+#include "abcgExternal.hpp"
+#include "abcgOpenGLExternal.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace abcg {
+struct ParticleBurst;
+struct OpenGLParticleSystemCreateInfo;
+class OpenGLParticleSystem;
+} // namespace abcg
+
+/**
+ * @brief Burst of particles emitted from a single point.
+ *
+ * @sa abcg::OpenGLParticleSystem::emit.
+ */
+struct abcg::ParticleBurst {
+  /** @brief Point of emission. */
+  glm::vec2 position{};
+  /** @brief Main direction of emission. Ignored if `spread` is 2π. */
+  glm::vec2 direction{0.0f, 1.0f};
+  /** @brief Angle, in radians, of the cone of emission around `direction`. */
+  float spread{glm::two_pi<float>()};
+  /** @brief Maximum initial speed. Each particle gets a random speed between
+   * half this value and this value. */
+  float speed{1.0f};
+  /** @brief Lifetime of each particle, in seconds. */
+  float lifetime{1.0f};
+  /** @brief Number of particles. */
+  std::size_t count{};
+  /** @brief Initial color. The alpha fades to zero over the lifetime. */
+  glm::vec4 color{1.0f};
+};
+
+/**
+ * @brief Configuration settings for creating an abcg::OpenGLParticleSystem.
+ */
+struct abcg::OpenGLParticleSystemCreateInfo {
+  /** @brief Maximum number of live particles. When a burst does not fit, it
+   * replaces the oldest particles. */
+  std::size_t capacity{1U << 17U};
+  /** @brief Constant acceleration applied to all particles. */
+  glm::vec2 gravity{};
+  /** @brief Fraction of the velocity lost per second. */
+  float drag{0.0f};
+  /** @brief Diameter of each particle, in pixels. */
+  float pointSize{3.0f};
+};
+
+/**
+ * @brief 2D particle system simulated and drawn entirely on the GPU.
+ *
+ * The particles are stored in two vertex buffers used in ping-pong fashion:
+ * each call to abcg::OpenGLParticleSystem::update reads one buffer in a vertex
+ * shader and writes the updated particles to the other buffer with transform
+ * feedback, with rasterization disabled. All particles are then drawn as
+ * points with a single draw call.
+ *
+ * New particles are emitted in bursts (abcg::ParticleBurst). The CPU only
+ * sends a few uniforms per burst; the vertex shader spawns the particles in
+ * the slots assigned to each burst, with pseudo-random directions and speeds
+ * derived from the particle index. Hence, the CPU cost per frame does not
+ * depend on the number of particles.
+ *
+ * Positions are given in the coordinate space transformed by the matrix set
+ * with abcg::OpenGLParticleSystem::setTransform (identity by default, that
+ * is, normalized device coordinates).
+ *
+ * @remark Requires OpenGL 3.3 or OpenGL ES 3.0 (WebGL 2.0).
+ * @remark The OpenGL resources are released by
+ * abcg::OpenGLParticleSystem::destroy, which must be called while the OpenGL
+ * context is current (e.g., in abcg::OpenGLWindow::onDestroy).
+ * @remark Objects of this type cannot be copied or copy-constructed.
+ */
+class abcg::OpenGLParticleSystem {
+public:
+  /** @brief Maximum number of bursts emitted per update. Additional bursts
+   * are dropped. */
+  static constexpr std::size_t maxBurstsPerUpdate{16};
+
+  OpenGLParticleSystem() = default;
+  OpenGLParticleSystem(OpenGLParticleSystem const &) = delete;
+  OpenGLParticleSystem &operator=(OpenGLParticleSystem const &) = delete;
+
+  void create(OpenGLParticleSystemCreateInfo const &createInfo = {});
+  void destroy();
+
+  void emit(ParticleBurst const &burst);
+  void update(float deltaTime);
+  void render() const;
+
+  void setTransform(glm::mat4 const &transform) noexcept;
+
+  [[nodiscard]] std::size_t getCapacity() const noexcept;
+  [[nodiscard]] bool isIdle() const noexcept;
+
+private:
+  struct UpdateLocations {
+    GLint deltaTime{-1};
+    GLint gravity{-1};
+    GLint drag{-1};
+    GLint capacity{-1};
+    GLint seed{-1};
+    GLint burstCount{-1};
+    GLint burstShape{-1};
+    GLint burstDirection{-1};
+    GLint burstColor{-1};
+    GLint burstRange{-1};
+  };
+
+  std::size_t m_capacity{};
+  glm::vec2 m_gravity{};
+  float m_drag{};
+  float m_pointSize{};
+  glm::mat4 m_transform{1.0f};
+
+  GLuint m_updateProgram{};
+  GLuint m_renderProgram{};
+  UpdateLocations m_updateLocations;
+  GLint m_transformLocation{-1};
+  GLint m_pointSizeLocation{-1};
+
+  // Ping-pong buffers and their vertex array objects. m_source holds the
+  // current particles
+  std::array<GLuint, 2> m_VBOs{};
+  std::array<GLuint, 2> m_VAOs{};
+  std::size_t m_source{};
+
+  std::vector<ParticleBurst> m_bursts;
+  // Next slot to be assigned to an emitted particle (ring buffer)
+  std::size_t m_nextSlot{};
+  std::uint32_t m_seed{};
+  // Time until the last emitted particle dies. While zero, update and render
+  // do nothing
+  float m_timeToIdle{};
+};
+
+#endif
@@ -153,39 +153,28 @@ void deleteShaders(std::vector<abcg::OpenGLShader> const &shaderIDs) {
     throw abcg::RuntimeError("Unknown shader stage");
   }
 }
-} // namespace
 
-/**
- * @brief Creates a program object from a group of shader paths or source codes.
- *
- * @param pathsOrSources Paths or source codes of the shaders to be compiled and
- * linked to the program.
- * @param throwOnError Whether to throw exceptions on compile/link errors.
- *
- * @throw abcg::RuntimeError if the shader could not be read from file, or if
- * the program could not be created, or if the compilation of any shader has
- * failed, or if the linking has failed.
- *
- * @return ID of the program object, or 0 on error.
- */
-GLuint
-abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
-                          bool throwOnError) {
-  std::vector<ShaderSource> sources;
+// Compiles and links the program, declaring the transform feedback varyings
+// (if any) before linking
+[[nodiscard]] GLuint
+createProgramHelper(std::vector<abcg::ShaderSource> const &pathsOrSources,
+                    std::vector<GLchar const *> const &varyings,
+                    GLenum bufferMode, bool throwOnError) {
+  std::vector<abcg::ShaderSource> sources;
   sources.reserve(pathsOrSources.size());
   for (auto const &pathOrSource : pathsOrSources) {
     sources.push_back(
         {.source = toSource(pathOrSource.source), .stage = pathOrSource.stage});
   }
 
-  std::vector<OpenGLShader> compiledShaders;
+  std::vector<abcg::OpenGLShader> compiledShaders;
   compiledShaders.reserve(sources.size());
   for (auto const &source : sources) {
     compiledShaders.push_back(
         compileHelper(source.source, abcgStageToOpenGLStage(source.stage)));
   }
 
-  if (!checkOpenGLShaderCompile(compiledShaders, throwOnError))
+  if (!abcg::checkOpenGLShaderCompile(compiledShaders, throwOnError))
     return 0U;
 
   auto const shaderProgram{glCreateProgram()};
@@ -201,6 +190,12 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
     glAttachShader(shaderProgram, shader.shader);
   }
 
+  if (!varyings.empty()) {
+    glTransformFeedbackVaryings(shaderProgram,
+                                gsl::narrow<GLsizei>(varyings.size()),
+                                varyings.data(), bufferMode);
+  }
+
   glLinkProgram(shaderProgram);
 
   for (auto const &shader : compiledShaders) {
@@ -223,6 +218,58 @@ abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
 
   return shaderProgram;
 }
+} // namespace
+
+/**
+ * @brief Creates a program object from a group of shader paths or source codes.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders to be compiled and
+ * linked to the program.
+ * @param throwOnError Whether to throw exceptions on compile/link errors.
+ *
+ * @throw abcg::RuntimeError if the shader could not be read from file, or if
+ * the program could not be created, or if the compilation of any shader has
+ * failed, or if the linking has failed.
+ *
+ * @return ID of the program object, or 0 on error.
+ */
+GLuint
+abcg::createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
+                          bool throwOnError) {
+  return createProgramHelper(pathsOrSources, {}, GL_INTERLEAVED_ATTRIBS,
+                             throwOnError);
+}
+
+/**
+ * @brief Creates a program object whose vertex shader outputs are captured
+ * with transform feedback.
+ *
+ * The varyings are declared with `glTransformFeedbackVaryings` before the
+ * program is linked, as required by OpenGL.
+ *
+ * @param pathsOrSources Paths or source codes of the shaders to be compiled and
+ * linked to the program.
+ * @param varyings Names of the output variables to be captured, in the order
+ * they are written to the transform feedback buffer(s).
+ * @param bufferMode `GL_INTERLEAVED_ATTRIBS` to write all varyings to a single
+ * buffer, or `GL_SEPARATE_ATTRIBS` to write each varying to its own buffer.
+ * @param throwOnError Whether to throw exceptions on compile/link errors.
+ *
+ * @throw abcg::RuntimeError if the shader could not be read from file, or if
+ * the program could not be created, or if the compilation of any shader has
+ * failed, or if the linking has failed.
+ *
+ * @return ID of the program object, or 0 on error.
+ *
+ * @sa abcg::OpenGLParticleSystem.
+ */
+GLuint abcg::createOpenGLTransformFeedbackProgram(
+    std::vector<ShaderSource> const &pathsOrSources,
+    std::vector<GLchar const *> const &varyings, GLenum bufferMode,
+    bool throwOnError) {
+  return createProgramHelper(pathsOrSources, varyings, bufferMode,
+                             throwOnError);
+}
 
 /**
  * @brief Triggers the compilation of a group of shaders and returns
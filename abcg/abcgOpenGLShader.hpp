@@ -34,6 +34,10 @@ namespace abcg {
 [[nodiscard]] GLuint
 createOpenGLProgram(std::vector<ShaderSource> const &pathsOrSources,
                     bool throwOnError = true);
+[[nodiscard]] GLuint createOpenGLTransformFeedbackProgram(
+    std::vector<ShaderSource> const &pathsOrSources,
+    std::vector<GLchar const *> const &varyings,
+    GLenum bufferMode = GL_INTERLEAVED_ATTRIBS, bool throwOnError = true);
 [[nodiscard]] std::vector<abcg::OpenGLShader>
 triggerOpenGLShaderCompile(std::vector<ShaderSource> const &pathsOrSources);
 bool checkOpenGLShaderCompile(std::vector<OpenGLShader> const &shaders,
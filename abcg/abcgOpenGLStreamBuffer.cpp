@@ -0,0 +1,294 @@
+/**
+ * @file abcgOpenGLStreamBuffer.cpp
+ * @brief Definition of abcg::OpenGLStreamBuffer members.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#include "abcgOpenGLStreamBuffer.hpp"
+
+#include <fmt/core.h>
+#include <gsl/gsl>
+
+#include <algorithm>
+
+#include "abcgException.hpp"
+#include "abcgOpenGLFunction.hpp"
+
+namespace {
+// Alignment of every allocation, enough for any vertex attribute type
+constexpr GLsizeiptr minAlignment{16};
+
+// Waits for the GPU to reach the fence, flushing the commands on the first
+// try so that the wait cannot block forever
+void clientWait(GLsync sync) {
+  GLbitfield flags{GL_SYNC_FLUSH_COMMANDS_BIT};
+  constexpr GLuint64 timeout{1'000'000'000}; // 1 s
+  while (true) {
+    switch (abcg::glClientWaitSync(sync, flags, timeout)) {
+    case GL_ALREADY_SIGNALED:
+    case GL_CONDITION_SATISFIED:
+      return;
+    case GL_WAIT_FAILED:
+      throw abcg::RuntimeError("Failed to wait for stream buffer fence");
+    default:
+      flags = 0;
+      break;
+    }
+  }
+}
+} // namespace
+
+/**
+ * @brief Creates the buffer.
+ *
+ * @param createInfo Configuration settings of the buffer.
+ *
+ * @throw abcg::RuntimeError if the size is not positive.
+ */
+void abcg::OpenGLStreamBuffer::create(
+    OpenGLStreamBufferCreateInfo const &createInfo) {
+  destroy();
+
+  if (createInfo.size <= 0)
+    throw abcg::RuntimeError("Stream buffer size must be positive");
+
+  m_target = createInfo.target;
+  m_alignment = minAlignment;
+  if (m_target == GL_UNIFORM_BUFFER) {
+    GLint uniformAlignment{};
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+    m_alignment = std::max(m_alignment, GLsizeiptr{uniformAlignment});
+  }
+  m_size = createInfo.size / m_alignment * m_alignment;
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(m_target, m_buffer);
+
+#if defined(__EMSCRIPTEN__)
+  m_staging.resize(gsl::narrow<std::size_t>(m_size));
+  glBufferData(m_target, m_size, nullptr, GL_STREAM_DRAW);
+#else
+  if (createInfo.allowPersistentMapping && GLEW_ARB_buffer_storage) {
+    GLbitfield const flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                           GL_MAP_COHERENT_BIT};
+    glBufferStorage(m_target, m_size, nullptr, flags);
+    m_persistentPointer = glMapBufferRange(m_target, 0, m_size, flags);
+    if (m_persistentPointer == nullptr)
+      throw abcg::RuntimeError("Failed to map stream buffer");
+  } else {
+    glBufferData(m_target, m_size, nullptr, GL_STREAM_DRAW);
+  }
+#endif
+
+  glBindBuffer(m_target, 0);
+}
+
+/**
+ * @brief Releases the buffer and the pending fences.
+ */
+void abcg::OpenGLStreamBuffer::destroy() {
+  for (auto const &region : m_fences) {
+    abcg::glDeleteSync(region.sync);
+  }
+  m_fences.clear();
+
+  if (m_buffer != 0) {
+    if (m_persistentPointer != nullptr) {
+      glBindBuffer(m_target, m_buffer);
+      glUnmapBuffer(m_target);
+      glBindBuffer(m_target, 0);
+    }
+    glDeleteBuffers(1, &m_buffer);
+  }
+
+  m_buffer = 0;
+  m_size = 0;
+  m_persistentPointer = nullptr;
+  m_staging.clear();
+  m_head = 0;
+  m_unfencedBegin = 0;
+}
+
+/**
+ * @brief Reserves a region of the ring for writing.
+ *
+ * The data must be written to the returned pointer and then passed to
+ * abcg::OpenGLStreamBuffer::commit before the next allocation and before any
+ * draw call that reads it. Waits if the region is still in use by the GPU.
+ *
+ * Without persistent mapping, the buffer is left bound to the target given
+ * at creation.
+ *
+ * @param size Size of the region, in bytes.
+ *
+ * @throw abcg::RuntimeError if the region is larger than the buffer, or if
+ * it would overwrite data that was not fenced yet (the buffer is too small
+ * for the data written between two fences).
+ *
+ * @return Offset and pointer of the region.
+ */
+abcg::OpenGLStreamAllocation
+abcg::OpenGLStreamBuffer::allocate(GLsizeiptr size) {
+  if (size <= 0 || size > m_size) {
+    throw abcg::RuntimeError(fmt::format(
+        "Stream buffer allocation of {} bytes does not fit in {} bytes", size,
+        m_size));
+  }
+
+  auto const ringSize{gsl::narrow<std::uint64_t>(m_size)};
+  auto const alignment{gsl::narrow<std::uint64_t>(m_alignment)};
+  auto const bytes{gsl::narrow<std::uint64_t>(size)};
+
+  // Aligns the start and skips the end of the ring if the region does not
+  // fit before it
+  auto begin{(m_head + alignment - 1) / alignment * alignment};
+  if (begin % ringSize + bytes > ringSize)
+    begin += ringSize - begin % ringSize;
+  auto const end{begin + bytes};
+
+  // Previous contents of [begin, end) were written at [begin - size,
+  // end - size)
+  if (end > ringSize) {
+    if (m_unfencedBegin < end - ringSize) {
+      throw abcg::RuntimeError(
+          "Stream buffer overflow: call fence() after the draw calls of each "
+          "frame, or create a larger buffer");
+    }
+    waitForFences(end - ringSize);
+  }
+  m_head = end;
+
+  auto const offset{gsl::narrow<GLintptr>(begin % ringSize)};
+  OpenGLStreamAllocation allocation{.offset = offset, .size = size};
+
+#if defined(__EMSCRIPTEN__)
+  allocation.pointer = m_staging.data() + offset;
+#else
+  if (m_persistentPointer != nullptr) {
+    allocation.pointer = static_cast<std::byte *>(m_persistentPointer) + offset;
+  } else {
+    glBindBuffer(m_target, m_buffer);
+    allocation.pointer = glMapBufferRange(
+        m_target, offset, size,
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+            GL_MAP_INVALIDATE_RANGE_BIT);
+    if (allocation.pointer == nullptr)
+      throw abcg::RuntimeError("Failed to map stream buffer");
+  }
+#endif
+
+  return allocation;
+}
+
+/**
+ * @brief Makes the data written to an allocation visible to the GPU.
+ *
+ * @param allocation Region returned by the last call to
+ * abcg::OpenGLStreamBuffer::allocate.
+ */
+void abcg::OpenGLStreamBuffer::commit(
+    [[maybe_unused]] OpenGLStreamAllocation const &allocation) {
+#if defined(__EMSCRIPTEN__)
+  glBindBuffer(m_target, m_buffer);
+  glBufferSubData(m_target, allocation.offset, allocation.size,
+                  allocation.pointer);
+#else
+  if (m_persistentPointer == nullptr) {
+    glBindBuffer(m_target, m_buffer);
+    glUnmapBuffer(m_target);
+  }
+#endif
+}
+
+/**
+ * @brief Inserts a fence after the commands that read the allocations made
+ * since the previous fence.
+ *
+ * Must be called after the draw calls that use the data, at least once per
+ * frame. The fences of previous calls that the GPU has already passed are
+ * released here.
+ *
+ * @throw abcg::RuntimeError if a previous fence cannot be queried.
+ */
+void abcg::OpenGLStreamBuffer::fence() {
+  if (m_head == m_unfencedBegin)
+    return;
+
+#if defined(__EMSCRIPTEN__)
+  // glBufferSubData copies the data, so the regions can be reused at once
+  m_unfencedBegin = m_head;
+#else
+  releaseSignaledFences();
+  auto *const sync{abcg::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)};
+  m_fences.push_back({.begin = m_unfencedBegin, .end = m_head, .sync = sync});
+  m_unfencedBegin = m_head;
+#endif
+}
+
+/**
+ * @brief Returns the buffer object, to be used in vertex attribute
+ * specifications or `glBindBufferRange`.
+ *
+ * @return Buffer object.
+ */
+GLuint abcg::OpenGLStreamBuffer::getBuffer() const noexcept {
+  return m_buffer;
+}
+
+/**
+ * @brief Returns the size of the ring.
+ *
+ * @return Size, in bytes.
+ */
+GLsizeiptr abcg::OpenGLStreamBuffer::getSize() const noexcept {
+  return m_size;
+}
+
+/**
+ * @brief Returns the alignment of the allocations.
+ *
+ * For `GL_UNIFORM_BUFFER`, this is at least
+ * `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`, so that consecutive uniform blocks
+ * written to a single allocation can be bound with `glBindBufferRange` if
+ * their stride is a multiple of this value.
+ *
+ * @return Alignment, in bytes.
+ */
+GLsizeiptr abcg::OpenGLStreamBuffer::getAlignment() const noexcept {
+  return m_alignment;
+}
+
+/**
+ * @brief Returns whether the buffer is persistently mapped.
+ *
+ * @return Whether `ARB_buffer_storage` is being used.
+ */
+bool abcg::OpenGLStreamBuffer::isPersistentlyMapped() const noexcept {
+  return m_persistentPointer != nullptr;
+}
+
+// Waits for (and releases) the fences of the regions that start before end
+void abcg::OpenGLStreamBuffer::waitForFences(std::uint64_t end) {
+  while (!m_fences.empty() && m_fences.front().begin < end) {
+    clientWait(m_fences.front().sync);
+    abcg::glDeleteSync(m_fences.front().sync);
+    m_fences.pop_front();
+  }
+}
+
+// Releases, without waiting, the fences already passed by the GPU. The GPU
+// signals the fences in order, so the first unsignaled one ends the search
+void abcg::OpenGLStreamBuffer::releaseSignaledFences() {
+  while (!m_fences.empty()) {
+    auto const status{abcg::glClientWaitSync(m_fences.front().sync, 0, 0)};
+    if (status == GL_WAIT_FAILED)
+      throw abcg::RuntimeError("Failed to query stream buffer fence");
+    if (status == GL_TIMEOUT_EXPIRED)
+      return;
+    abcg::glDeleteSync(m_fences.front().sync);
+    m_fences.pop_front();
+  }
+}
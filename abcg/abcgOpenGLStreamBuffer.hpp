@@ -0,0 +1,135 @@
+/**
+ * @file abcgOpenGLStreamBuffer.hpp
+ * @brief Header file of abcg::OpenGLStreamBuffer.
+ *
+ * Declaration of abcg::OpenGLStreamBuffer class.
+ *
+ * This file is part of ABCg (https://github.com/hbatagelo/abcg).
+ *
+ * This file is released under the MIT License.
+ */
+
+#ifndef ABCG_OPENGL_STREAM_BUFFER_HPP_
+#define ABCG_OPENGL_STREAM_BUFFER_HPP_
+
+#include "abcgOpenGLExternal.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace abcg {
+struct OpenGLStreamBufferCreateInfo;
+struct OpenGLStreamAllocation;
+class OpenGLStreamBuffer;
+} // namespace abcg
+
+/**
+ * @brief Configuration settings for creating an abcg::OpenGLStreamBuffer.
+ */
+struct abcg::OpenGLStreamBufferCreateInfo {
+  /** @brief Binding target of the buffer (e.g., `GL_ARRAY_BUFFER` or
+   * `GL_UNIFORM_BUFFER`). */
+  GLenum target{GL_ARRAY_BUFFER};
+  /** @brief Size of the ring, in bytes. Must hold all the data written
+   * between two calls to abcg::OpenGLStreamBuffer::fence. */
+  GLsizeiptr size{GLsizeiptr{4} << 20};
+  /** @brief Whether to use a persistently mapped buffer when
+   * `ARB_buffer_storage` is available. */
+  bool allowPersistentMapping{true};
+};
+
+/**
+ * @brief Region of an abcg::OpenGLStreamBuffer returned by
+ * abcg::OpenGLStreamBuffer::allocate.
+ */
+struct abcg::OpenGLStreamAllocation {
+  /** @brief Offset of the region in the buffer, in bytes. To be used as the
+   * offset of vertex attributes or in `glBindBufferRange`. */
+  GLintptr offset{};
+  /** @brief Pointer to which the data must be written before
+   * abcg::OpenGLStreamBuffer::commit. */
+  void *pointer{};
+  /** @brief Size of the region, in bytes. */
+  GLsizeiptr size{};
+};
+
+/**
+ * @brief Buffer for data that changes every frame, such as per-instance
+ * attributes or uniform blocks.
+ *
+ * A single large buffer is sub-allocated as a ring. Each allocation returns
+ * an offset in the buffer and a pointer to write the data to, so that no
+ * buffer is created or resized after abcg::OpenGLStreamBuffer::create.
+ *
+ * The data is written without implicit synchronization with the GPU:
+ *
+ * - with a persistently and coherently mapped buffer (`glBufferStorage`),
+ * when `ARB_buffer_storage` is available. The pointer points directly into
+ * the buffer and commit does nothing;
+ * - otherwise, with `glMapBufferRange` and `GL_MAP_UNSYNCHRONIZED_BIT`,
+ * unmapped on commit;
+ * - on WebGL, which has no buffer mapping, the data is written to a copy in
+ * client memory and uploaded with `glBufferSubData` on commit.
+ *
+ * Instead, the application calls abcg::OpenGLStreamBuffer::fence after
+ * issuing the draw calls that read the allocations, which inserts a fence
+ * (`glFenceSync`). Before a region of the ring is reused, the buffer waits
+ * for the fences of the previous data in that region. In the usual case, the
+ * GPU has long finished with that data and the wait returns immediately.
+ * The fences the GPU has already passed are released at each call to
+ * abcg::OpenGLStreamBuffer::fence, so only the fences of the data still in
+ * flight are kept, however large the ring is.
+ *
+ * @remark The OpenGL resources are released by
+ * abcg::OpenGLStreamBuffer::destroy, which must be called while the OpenGL
+ * context is current (e.g., in abcg::OpenGLWindow::onDestroy).
+ * @remark Objects of this type cannot be copied or copy-constructed.
+ */
+class abcg::OpenGLStreamBuffer {
+public:
+  OpenGLStreamBuffer() = default;
+  OpenGLStreamBuffer(OpenGLStreamBuffer const &) = delete;
+  OpenGLStreamBuffer &operator=(OpenGLStreamBuffer const &) = delete;
+
+  void create(OpenGLStreamBufferCreateInfo const &createInfo = {});
+  void destroy();
+
+  [[nodiscard]] OpenGLStreamAllocation allocate(GLsizeiptr size);
+  void commit(OpenGLStreamAllocation const &allocation);
+  void fence();
+
+  [[nodiscard]] GLuint getBuffer() const noexcept;
+  [[nodiscard]] GLsizeiptr getSize() const noexcept;
+  [[nodiscard]] GLsizeiptr getAlignment() const noexcept;
+  [[nodiscard]] bool isPersistentlyMapped() const noexcept;
+
+private:
+  // Region of the ring written before a fence. Positions grow monotonically;
+  // the offset in the buffer is the position modulo the ring size
+  struct FencedRegion {
+    std::uint64_t begin{};
+    std::uint64_t end{};
+    GLsync sync{};
+  };
+
+  GLuint m_buffer{};
+  GLenum m_target{};
+  GLsizeiptr m_size{};
+  GLsizeiptr m_alignment{};
+
+  // Base of the persistent mapping, if any
+  void *m_persistentPointer{};
+  // Client copy of the ring, on WebGL
+  std::vector<std::byte> m_staging;
+
+  std::uint64_t m_head{};
+  std::uint64_t m_unfencedBegin{};
+  std::deque<FencedRegion> m_fences;
+
+  void waitForFences(std::uint64_t end);
+  void releaseSignaledFences();
+};
+
+#endif
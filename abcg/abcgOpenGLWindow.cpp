@@ -222,6 +222,21 @@ void abcg::OpenGLWindow::onUpdate() {}
  */
 void abcg::OpenGLWindow::onDestroy() {}
 
+/**
+ * @brief Returns the timer that estimates when each frame is displayed.
+ *
+ * During abcg::OpenGLWindow::onPaint, abcg::OpenGLFrameTimer::getFrameNumber
+ * is the number of the frame being painted. Its timing is available from
+ * abcg::OpenGLFrameTimer::getTiming a few frames later, once the GPU has
+ * finished it.
+ *
+ * @returns Reference to the frame timer of the window.
+ */
+abcg::OpenGLFrameTimer const &
+abcg::OpenGLWindow::getFrameTimer() const noexcept {
+  return m_frameTimer;
+}
+
 void abcg::OpenGLWindow::handleEvent(SDL_Event const &event) {
   if (event.window.windowID != abcg::Window::getSDLWindowID())
     return;
@@ -419,6 +434,18 @@ void abcg::OpenGLWindow::create() {
     throw abcg::RuntimeError("Failed to load font file");
   }
 
+  // Presentation timing of the frames, from the display refresh rate until
+  // it is measured
+  int refreshRate{};
+  auto const displayIndex{
+      SDL_GetWindowDisplayIndex(abcg::Window::getSDLWindow())};
+  if (SDL_DisplayMode mode{};
+      displayIndex >= 0 &&
+      SDL_GetCurrentDisplayMode(displayIndex, &mode) == 0) {
+    refreshRate = mode.refresh_rate;
+  }
+  m_frameTimer.create(m_openGLSettings.vSync, refreshRate);
+
   onCreate();
 
   onResize(getWindowSize());
@@ -431,6 +458,7 @@ void abcg::OpenGLWindow::paint() {
     return;
 
   SDL_GL_MakeCurrent(abcg::Window::getSDLWindow(), m_GLContext);
+  m_frameTimer.poll();
 
 #if defined(__EMSCRIPTEN__)
   // Force window size in windowed mode
@@ -454,16 +482,20 @@ void abcg::OpenGLWindow::paint() {
   onPaint();
 
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  m_frameTimer.beforeSwap();
   if (m_openGLSettings.doubleBuffering) {
     SDL_GL_SwapWindow(abcg::Window::getSDLWindow());
   } else {
     glFinish();
   }
+  m_frameTimer.afterSwap();
 }
 
 void abcg::OpenGLWindow::destroy() {
   onDestroy();
 
+  if (m_GLContext != nullptr)
+    m_frameTimer.destroy();
   if (ImGui::GetCurrentContext() != nullptr) {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
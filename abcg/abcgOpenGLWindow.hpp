@@ -16,6 +16,7 @@
 #include <string>
 
 #include "abcgExternal.hpp"
+#include "abcgOpenGLFrameTimer.hpp"
 #include "abcgOpenGLFunction.hpp"
 #include "abcgWindow.hpp"
 
@@ -111,6 +112,8 @@ protected:
   virtual void onUpdate();
   virtual void onDestroy();
 
+  [[nodiscard]] OpenGLFrameTimer const &getFrameTimer() const noexcept;
+
 private:
   void handleEvent(SDL_Event const &event) final;
   void create() final;
@@ -121,6 +124,7 @@ private:
   OpenGLSettings m_openGLSettings;
   std::string m_GLSLVersion;
   SDL_GLContext m_GLContext{};
+  OpenGLFrameTimer m_frameTimer;
   bool m_hidden{};
   bool m_minimized{};
 };
@@ -132,6 +132,7 @@ int abcg::resizingEventWatcher(void *data, SDL_Event *event) {
       abcg::Window &window{*(
           static_cast<abcg::Window *>(SDL_GetWindowData(SDLWindow, "window")))};
       if (window.m_enableResizingEventWatcher) {
+        window.m_eventTime = std::chrono::steady_clock::now();
         [[maybe_unused]] bool done{};
         window.templateHandleEvent(*event, done);
         window.templatePaint();
@@ -173,6 +174,25 @@ double abcg::Window::getDeltaTime() const noexcept { return m_lastDeltaTime; }
  */
 double abcg::Window::getElapsedTime() const { return m_elapsedTime.elapsed(); }
 
+/**
+ * @brief Returns the time at which the event being handled was polled.
+ *
+ * The event is stamped with `std::chrono::steady_clock` as soon as
+ * `SDL_PollEvent` returns it, before any other processing. Unlike the SDL
+ * event timestamp, which is given in milliseconds, this time has the
+ * resolution of the steady clock (usually nanoseconds), which makes it
+ * suitable for measuring input latency.
+ *
+ * Only meaningful while handling an event (e.g., in
+ * abcg::OpenGLWindow::onEvent).
+ *
+ * @returns Time point of the steady clock.
+ */
+std::chrono::steady_clock::time_point
+abcg::Window::getEventTime() const noexcept {
+  return m_eventTime;
+}
+
 /**
  * @brief Returns the current configuration settings of the window.
  *
@@ -233,7 +253,8 @@ Uint32 abcg::Window::getSDLWindowID() const noexcept { return m_windowID; }
  * @brief Creates the SDL window.
  *
  * @param extraFlags Extra SDL window flags to be combined with the common
- * flags (`SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI`).
+ * flags (`SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI`, plus
+ * `SDL_WINDOW_HIDDEN` if abcg::WindowSettings::hidden is set).
  *
  * @returns `true` on success; `false` on failure.
  */
@@ -242,11 +263,13 @@ bool abcg::Window::createSDLWindow(SDL_WindowFlags extraFlags) {
     return false;
 
   auto commonFlags{SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI};
+  auto const hiddenFlags{m_windowSettings.hidden ? SDL_WINDOW_HIDDEN : 0};
 
   m_window = SDL_CreateWindow(
       m_windowSettings.title.c_str(), SDL_WINDOWPOS_CENTERED,
       SDL_WINDOWPOS_CENTERED, m_windowSettings.width, m_windowSettings.height,
-      gsl::narrow<Uint32>(extraFlags) | gsl::narrow<Uint32>(commonFlags));
+      gsl::narrow<Uint32>(extraFlags) | gsl::narrow<Uint32>(commonFlags) |
+          gsl::narrow<Uint32>(hiddenFlags));
   if (m_window == nullptr)
     return false;
 
@@ -13,6 +13,7 @@
 #ifndef ABCG_WINDOW_HPP_
 #define ABCG_WINDOW_HPP_
 
+#include <chrono>
 #include <string>
 
 #include "abcgExternal.hpp"
@@ -68,6 +69,27 @@ struct abcg::WindowSettings {
   std::string fullscreenElementID{"#canvas"};
   /** @brief String containing the window title. */
   std::string title{"ABCg Window"};
+  /** @brief Whether to create the window hidden.
+   *
+   * Useful for offscreen rendering, such as benchmarks that need a graphics
+   * context but no visible window.
+   */
+  bool hidden{false};
+  /** @brief Rate, in Hz, at which input events are sampled between frames,
+   * or 0 to poll them only once per frame.
+   *
+   * When positive, the main loop paces the frames at the refresh rate of the
+   * display and, while waiting for the next frame, polls the SDL events at
+   * this rate. Events are then handled (and stamped, see
+   * abcg::Window::getEventTime) at most one sampling period after they
+   * arrive, instead of up to one frame later.
+   *
+   * SDL only pumps events in the thread that created the window, so the
+   * sampling happens in the main thread. Intended to be used with vertical
+   * synchronization disabled, since a blocking buffer swap delays the
+   * sampling. Ignored in WebAssembly builds.
+   */
+  int inputSamplingRate{0};
 };
 
 /**
@@ -154,6 +176,8 @@ protected:
 
   [[nodiscard]] double getDeltaTime() const noexcept;
   [[nodiscard]] double getElapsedTime() const;
+  [[nodiscard]] std::chrono::steady_clock::time_point
+  getEventTime() const noexcept;
   [[nodiscard]] SDL_Window *getSDLWindow() const noexcept;
   [[nodiscard]] Uint32 getSDLWindowID() const noexcept;
 
@@ -175,6 +199,8 @@ private:
   Timer m_deltaTime;
   Timer m_elapsedTime;
   double m_lastDeltaTime{};
+  std::chrono::steady_clock::time_point m_eventTime{};
+  std::chrono::steady_clock::time_point m_nextFrameTime{};
 
   bool m_enableResizingEventWatcher{true};
 
@@ -0,0 +1,237 @@
+#include "analytics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace {
+
+// Somas de ponto flutuante em lanes acumuladores independentes. Sem
+// -ffast-math, o compilador não muda a ordem das somas de uma redução e não
+// pode vetorizá-la; com a ordem já escrita assim, cada acumulador vira uma
+// pista de um registrador vetorial
+constexpr std::size_t lanes{8};
+
+template <typename Term> double sumLanes(std::size_t count, Term term) {
+  std::array<double, lanes> partial{};
+  std::size_t i{};
+  for (; i + lanes <= count; i += lanes) {
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+      partial[lane] += term(i + lane);
+    }
+  }
+  double total{};
+  for (; i < count; ++i) {
+    total += term(i);
+  }
+  for (auto const value : partial) {
+    total += value;
+  }
+  return total;
+}
+
+// Marca os frames em que a bola cruzou a linha de disparo para baixo, com as
+// condições combinadas sem desvios (TriggerZone::crossed). previous é a
+// posição do último frame do bloco anterior
+void markCrossings(std::span<TelemetryFrame const> frames, glm::vec2 previous,
+                   TriggerZone const &zone, std::span<std::uint8_t> crossed) {
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    auto const previousY{i > 0 ? frames[i - 1].ballPosition.y : previous.y};
+    auto const position{frames[i].ballPosition};
+    crossed[i] = static_cast<std::uint8_t>(
+        static_cast<int>(previousY > zone.lineY) &
+        static_cast<int>(position.y <= zone.lineY) &
+        static_cast<int>(position.x >= zone.minX) &
+        static_cast<int>(position.x <= zone.maxX));
+  }
+}
+
+float median(std::vector<float> values) {
+  auto const middle{values.begin() +
+                    static_cast<std::ptrdiff_t>(values.size() / 2)};
+  std::nth_element(values.begin(), middle, values.end());
+  if (values.size() % 2 == 1)
+    return *middle;
+  return (*middle + *std::max_element(values.begin(), middle)) / 2.0f;
+}
+
+} // namespace
+
+SessionReactions analyzeSession(std::span<std::uint8_t const> data,
+                                TriggerZone const &zone) {
+  TelemetryReader reader{data};
+  SessionReactions session;
+  session.patient = reader.getHeader().patient;
+  session.startTime = reader.getHeader().startTime;
+
+  session.recordedStimuli = reader.getHeader().version >= 3;
+
+  // Só os estímulos e os instantes das respostas são guardados; os blocos
+  // são descartados depois de lidos
+  std::vector<TelemetryStimulus> stimuli;
+  std::vector<std::chrono::nanoseconds> responses;
+  std::vector<std::uint8_t> crossed;
+  std::optional<glm::vec2> previous;
+  // A repetição automática do teclado gera pressões seguidas sem soltar a
+  // tecla, que o jogo não conta como resposta
+  bool leftDown{};
+  bool rightDown{};
+
+  TelemetryLog block;
+  while (reader.next(block)) {
+    stimuli.insert(stimuli.end(), block.stimuli.begin(), block.stimuli.end());
+    if (!block.frames.empty() && !session.recordedStimuli) {
+      std::span<TelemetryFrame const> const frames{block.frames};
+      crossed.resize(frames.size());
+      markCrossings(frames, previous.value_or(frames.front().ballPosition),
+                    zone, crossed);
+      for (std::size_t i = 0; i < frames.size(); ++i) {
+        if (crossed[i] != 0)
+          stimuli.push_back({.time = frames[i].time,
+                             .displayDelay = std::nullopt});
+      }
+      previous = frames.back().ballPosition;
+    }
+    session.frames += block.frames.size();
+
+    using Input = Simulation::Input;
+    for (auto const &input : block.inputs) {
+      auto const press{[&](bool &down) {
+        if (!down)
+          responses.push_back(input.time);
+        down = true;
+      }};
+      if (input.input == Input::LeftFlipperDown)
+        press(leftDown);
+      else if (input.input == Input::RightFlipperDown)
+        press(rightDown);
+      else if (input.input == Input::LeftFlipperUp)
+        leftDown = false;
+      else if (input.input == Input::RightFlipperUp)
+        rightDown = false;
+    }
+
+    block.frames.clear();
+    block.inputs.clear();
+    block.stimuli.clear();
+  }
+  session.complete = block.complete;
+
+  // Os blocos de frames e de entradas são gravados separadamente: os dois
+  // fluxos só são intercalados aqui, em ordem de tempo
+  std::sort(stimuli.begin(), stimuli.end(),
+            [](TelemetryStimulus const &a, TelemetryStimulus const &b) {
+              return a.time < b.time;
+            });
+  std::sort(responses.begin(), responses.end());
+  using Clock = ReactionTimer::Clock;
+  auto const at{[](std::chrono::nanoseconds time) {
+    return Clock::time_point{std::chrono::duration_cast<Clock::duration>(time)};
+  }};
+  ReactionTimer timer;
+  auto response{responses.begin()};
+  for (auto const &stimulus : stimuli) {
+    for (; response != responses.end() && *response < stimulus.time;
+         ++response)
+      timer.respond(at(*response));
+    timer.stimulus(at(stimulus.time));
+    // No jogo, a exibição é estimada poucos frames depois do estímulo, antes
+    // das respostas
+    if (stimulus.displayDelay)
+      timer.presented(timer.getAttempts().size() - 1,
+                      at(stimulus.time + *stimulus.displayDelay));
+  }
+  for (; response != responses.end(); ++response)
+    timer.respond(at(*response));
+
+  using Milliseconds = std::chrono::duration<float, std::milli>;
+  session.attempts = timer.getAttempts().size();
+  for (auto const &attempt : timer.getAttempts()) {
+    if (auto const latency{attempt.displayLatency()})
+      session.latencies.push_back(Milliseconds(*latency).count());
+  }
+  return session;
+}
+
+LatencyStats computeLatencyStats(std::span<float> latencies) {
+  LatencyStats stats{.count = latencies.size()};
+  if (latencies.empty())
+    return stats;
+
+  auto const *values{latencies.data()};
+  auto const count{static_cast<double>(latencies.size())};
+  stats.mean =
+      sumLanes(latencies.size(), [values](std::size_t i) {
+        return static_cast<double>(values[i]);
+      }) /
+      count;
+  auto const mean{stats.mean};
+  stats.deviation = std::sqrt(
+      sumLanes(latencies.size(),
+               [values, mean](std::size_t i) {
+                 auto const difference{static_cast<double>(values[i]) - mean};
+                 return difference * difference;
+               }) /
+      count);
+
+  // Percentil pelo posto mais próximo
+  std::sort(latencies.begin(), latencies.end());
+  constexpr std::array<double, 5> ranks{0.10, 0.25, 0.50, 0.75, 0.90};
+  for (std::size_t i = 0; i < ranks.size(); ++i) {
+    auto const index{static_cast<std::size_t>(
+        std::lround(ranks[i] * static_cast<double>(latencies.size() - 1)))};
+    stats.percentiles[i] = latencies[index];
+  }
+  return stats;
+}
+
+// Em duas passadas, com x e y centrados nas médias, para não perder
+// precisão com x grandes (dias desde 1970)
+LinearFit fitLine(std::span<double const> x, std::span<double const> y) {
+  auto const count{std::min(x.size(), y.size())};
+  auto const *xs{x.data()};
+  auto const *ys{y.data()};
+  auto const meanX{sumLanes(count, [xs](std::size_t i) { return xs[i]; }) /
+                   static_cast<double>(count)};
+  auto const meanY{sumLanes(count, [ys](std::size_t i) { return ys[i]; }) /
+                   static_cast<double>(count)};
+
+  auto const sxx{sumLanes(count, [xs, meanX](std::size_t i) {
+    return (xs[i] - meanX) * (xs[i] - meanX);
+  })};
+  auto const sxy{sumLanes(count, [xs, ys, meanX, meanY](std::size_t i) {
+    return (xs[i] - meanX) * (ys[i] - meanY);
+  })};
+  auto const syy{sumLanes(count, [ys, meanY](std::size_t i) {
+    return (ys[i] - meanY) * (ys[i] - meanY);
+  })};
+
+  LinearFit fit;
+  fit.slope = sxy / sxx;
+  fit.intercept = meanY - fit.slope * meanX;
+  // Com y constante, a reta passa por todos os pontos
+  fit.r2 = syy > 0.0 ? (sxy * sxy) / (sxx * syy) : 1.0;
+  return fit;
+}
+
+void PatientReactions::merge(SessionReactions const &session) {
+  ++sessions;
+  if (!session.recordedStimuli)
+    ++approximateSessions;
+  attempts += session.attempts;
+  latencies.insert(latencies.end(), session.latencies.begin(),
+                   session.latencies.end());
+  if (session.latencies.empty())
+    return;
+
+  using Days = std::chrono::duration<double, std::ratio<86400>>;
+  sessionDays.push_back(Days(session.startTime).count());
+  sessionMedians.push_back(median(session.latencies));
+}
+
+double PatientReactions::missRate() const noexcept {
+  if (attempts == 0)
+    return 0.0;
+  return 1.0 - static_cast<double>(latencies.size()) /
+                   static_cast<double>(attempts);
+}
@@ -0,0 +1,83 @@
+#ifndef ANALYTICS_HPP_
+#define ANALYTICS_HPP_
+
+#include "reactiontimer.hpp"
+#include "telemetry.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Análise dos tempos de reação gravados na telemetria (pinball_analytics)
+
+// Tentativas de uma sessão, refeitas a partir da telemetria com as mesmas
+// regras do jogo (ReactionTimer): o estímulo é o frame em que a bola
+// desenhada cruza a zona de disparo, e a resposta, a primeira pressão de
+// flipper seguinte.
+//
+// A partir da versão 3 da telemetria, os estímulos são os gravados pelo
+// jogo, com o atraso de exibição de cada um, e as latências são as mesmas do
+// histórico do paciente (SessionStore): a partir da exibição do estímulo. Nas
+// versões anteriores, os estímulos são detectados na posição da bola no
+// último passo de cada frame, que difere da desenhada em até um frame, e as
+// latências contam a partir da montagem do frame
+struct SessionReactions {
+  std::string patient;
+  std::chrono::milliseconds startTime{};
+  std::size_t attempts{};
+  // Latências das tentativas com resposta, em ms
+  std::vector<float> latencies;
+  // Se os estímulos vieram da telemetria (versão 3), e não da trajetória
+  bool recordedStimuli{};
+  std::uint64_t frames{};
+  // Se o arquivo foi fechado normalmente
+  bool complete{};
+};
+
+// Lê a telemetria bloco a bloco, guardando só os estímulos e as respostas,
+// de modo que a memória não cresce com a duração da sessão
+SessionReactions analyzeSession(std::span<std::uint8_t const> data,
+                                TriggerZone const &zone);
+
+// Estatísticas de uma amostra de latências
+struct LatencyStats {
+  std::size_t count{};
+  double mean{};
+  double deviation{};
+  // Percentis 10, 25, 50, 75 e 90
+  std::array<float, 5> percentiles{};
+};
+
+// Reordena latencies
+LatencyStats computeLatencyStats(std::span<float> latencies);
+
+// Reta de mínimos quadrados y = slope * x + intercept
+struct LinearFit {
+  double slope{};
+  double intercept{};
+  // Coeficiente de determinação (0 a 1)
+  double r2{};
+};
+
+// Requer ao menos dois valores distintos de x
+LinearFit fitLine(std::span<double const> x, std::span<double const> y);
+
+// Sessões de um paciente, acumuladas na etapa de junção
+struct PatientReactions {
+  std::size_t sessions{};
+  // Sessões com os estímulos detectados na trajetória (telemetria antiga)
+  std::size_t approximateSessions{};
+  std::size_t attempts{};
+  std::vector<float> latencies;
+  // Início de cada sessão com resposta, em dias, e a sua mediana, em ms
+  std::vector<double> sessionDays;
+  std::vector<double> sessionMedians;
+
+  void merge(SessionReactions const &session);
+  [[nodiscard]] double missRate() const noexcept;
+};
+
+#endif
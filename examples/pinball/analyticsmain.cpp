@@ -0,0 +1,245 @@
+// pinball_analytics: estatísticas de tempo de reação por paciente, a partir
+// dos arquivos de telemetria gravados pelo jogo (--telemetry). Uso:
+//
+//   pinball_analytics [--threads N] [--table MESA] [--patient ID]
+//                     CAMINHO...
+//
+// Cada CAMINHO é um arquivo de telemetria ou um diretório, percorrido
+// recursivamente atrás de arquivos .pbtm. Os arquivos passam, em paralelo,
+// pelas etapas de leitura (mapeamento em memória), decodificação e
+// agregação por sessão; a junção por paciente vem depois, também em
+// paralelo. Cada arquivo é lido um bloco por vez, e só os tempos de reação
+// de cada sessão ficam na memória.
+//
+// Para cada paciente são mostrados as sessões, as tentativas, a taxa de
+// tentativas sem resposta, a média, o desvio padrão e os percentis das
+// latências, e a tendência da mediana por sessão (regressão linear), em ms
+// por semana.
+//
+// As latências são as do histórico do paciente: a partir da exibição do
+// estímulo, com os estímulos gravados pelo jogo. Os arquivos anteriores à
+// versão 3 da telemetria não têm os estímulos, que são detectados na
+// trajetória da bola, sem a correção da exibição; as sessões assim
+// aproximadas são contadas na saída de erros.
+
+#include "analytics.hpp"
+#include "mappedfile.hpp"
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fmt/core.h>
+#include <map>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct Options {
+  unsigned threads{0};
+  std::string table;
+  std::string patient;
+  std::vector<std::string> paths;
+};
+
+template <typename T> T parseNumber(std::string_view text) {
+  T value{};
+  auto const *last{text.data() + text.size()};
+  auto const [ptr, ec]{std::from_chars(text.data(), last, value)};
+  if (ec != std::errc{} || ptr != last)
+    throw std::runtime_error(fmt::format("Invalid number: {}", text));
+  return value;
+}
+
+Options parseOptions(std::span<char *> args) {
+  Options options;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    std::string_view const arg{args[i]};
+    if (!arg.starts_with("--")) {
+      options.paths.emplace_back(arg);
+      continue;
+    }
+    auto value = [&]() -> std::string_view {
+      if (i + 1 >= args.size())
+        throw std::runtime_error(fmt::format("Missing value for {}", arg));
+      return args[++i];
+    };
+
+    if (arg == "--threads")
+      options.threads = parseNumber<unsigned>(value());
+    else if (arg == "--table")
+      options.table = value();
+    else if (arg == "--patient")
+      options.patient = value();
+    else
+      throw std::runtime_error(fmt::format("Unknown option: {}", arg));
+  }
+  if (options.paths.empty())
+    throw std::runtime_error("No telemetry files given");
+  return options;
+}
+
+std::vector<std::filesystem::path>
+findTelemetryFiles(std::vector<std::string> const &paths) {
+  std::vector<std::filesystem::path> files;
+  for (auto const &path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      files.emplace_back(path);
+      continue;
+    }
+    for (auto const &entry :
+         std::filesystem::recursive_directory_iterator(path)) {
+      if (entry.is_regular_file() && entry.path().extension() == ".pbtm")
+        files.push_back(entry.path());
+    }
+  }
+  return files;
+}
+
+// Sessão de um arquivo, ou o erro que impediu a sua leitura
+struct FileResult {
+  SessionReactions session;
+  std::string error;
+};
+
+struct PatientReport {
+  LatencyStats latency;
+  std::optional<LinearFit> trend;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    auto const options{
+        parseOptions(std::span{argv, static_cast<std::size_t>(argc)})};
+    auto const table{options.table.empty() ? Table::builtin()
+                                           : Table::load(options.table)};
+    auto const zone{TriggerZone::fromTable(table)};
+    auto const files{findTelemetryFiles(options.paths)};
+
+    std::vector<FileResult> results(files.size());
+    std::map<std::string, PatientReactions> patients;
+    std::vector<std::pair<std::string const *, PatientReactions *>> order;
+    std::vector<PatientReport> reports;
+    std::atomic<std::uint64_t> totalBytes{0};
+
+    auto const start{std::chrono::steady_clock::now()};
+    {
+      ThreadPool pool{options.threads};
+      fmt::print(stderr, "Analyzing {} files on {} threads\n", files.size(),
+                 pool.size());
+
+      // Leitura, decodificação e agregação, uma tarefa por arquivo. Um
+      // arquivo inválido não interrompe os outros
+      for (std::size_t i = 0; i < files.size(); ++i) {
+        pool.submit([&, i] {
+          try {
+            MappedFile const file{files[i].string()};
+            auto const data{file.getData()};
+            totalBytes.fetch_add(data.size(), std::memory_order_relaxed);
+            results[i].session = analyzeSession(
+                {reinterpret_cast<std::uint8_t const *>(data.data()),
+                 data.size()},
+                zone);
+          } catch (std::exception const &exception) {
+            results[i].error = exception.what();
+          }
+        });
+      }
+      pool.wait();
+
+      // Junção por paciente, na ordem dos arquivos
+      for (std::size_t i = 0; i < files.size(); ++i) {
+        auto const &result{results[i]};
+        if (!result.error.empty()) {
+          fmt::print(stderr, "{}: {}\n", files[i].string(), result.error);
+          continue;
+        }
+        auto const &patient{result.session.patient};
+        if (!options.patient.empty() && patient != options.patient)
+          continue;
+        patients[patient.empty() ? "(none)" : patient].merge(result.session);
+      }
+      results.clear();
+
+      // Estatísticas de cada paciente, em paralelo
+      for (auto &[patient, reactions] : patients) {
+        order.emplace_back(&patient, &reactions);
+      }
+      reports.resize(order.size());
+      for (std::size_t i = 0; i < order.size(); ++i) {
+        pool.submit([&, i] {
+          auto &reactions{*order[i].second};
+          auto &report{reports[i]};
+          report.latency = computeLatencyStats(reactions.latencies);
+          // Tendência só com sessões em pelo menos dois dias diferentes
+          auto const &days{reactions.sessionDays};
+          auto const [first, last]{
+              std::minmax_element(days.begin(), days.end())};
+          if (days.size() >= 2 && *last - *first >= 1.0)
+            report.trend = fitLine(days, reactions.sessionMedians);
+        });
+      }
+      pool.wait();
+    }
+    std::chrono::duration<double> const wallTime{
+        std::chrono::steady_clock::now() - start};
+
+    fmt::print("{:<16} {:>8} {:>8} {:>6} {:>7} {:>7} {:>7} {:>7} {:>7} {:>7} "
+               "{:>7} {:>9} {:>5}\n",
+               "patient", "sessions", "attempts", "miss%", "mean", "sd", "p10",
+               "p25", "p50", "p75", "p90", "ms/week", "r2");
+    for (std::size_t i = 0; i < order.size(); ++i) {
+      auto const &reactions{*order[i].second};
+      auto const &report{reports[i]};
+      fmt::print("{:<16} {:>8} {:>8} {:>5.1f}%", *order[i].first,
+                 reactions.sessions, reactions.attempts,
+                 reactions.missRate() * 100.0);
+      if (report.latency.count > 0) {
+        auto const &percentiles{report.latency.percentiles};
+        fmt::print(" {:>7.1f} {:>7.1f} {:>7.1f} {:>7.1f} {:>7.1f} {:>7.1f} "
+                   "{:>7.1f}",
+                   report.latency.mean, report.latency.deviation,
+                   percentiles[0], percentiles[1], percentiles[2],
+                   percentiles[3], percentiles[4]);
+      } else {
+        fmt::print(" {:>7} {:>7} {:>7} {:>7} {:>7} {:>7} {:>7}", "-", "-",
+                   "-", "-", "-", "-", "-");
+      }
+      if (report.trend)
+        fmt::print(" {:>+9.2f} {:>5.2f}\n", report.trend->slope * 7.0,
+                   report.trend->r2);
+      else
+        fmt::print(" {:>9} {:>5}\n", "-", "-");
+    }
+
+    std::size_t approximate{};
+    for (auto const &[patient, reactions] : order) {
+      approximate += reactions->approximateSessions;
+    }
+    if (approximate > 0)
+      fmt::print(stderr,
+                 "{} sessions predate recorded stimuli: their stimuli were "
+                 "detected from the ball path, without display correction\n",
+                 approximate);
+
+    auto const megabytes{
+        static_cast<double>(totalBytes.load(std::memory_order_relaxed)) /
+        1e6};
+    fmt::print(stderr, "{:.1f} MB in {:.2f} s, {:.0f} MB/s\n", megabytes,
+               wallTime.count(), megabytes / wallTime.count());
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,406 @@
+#include "ballset.hpp"
+#include "collision.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+void BallSet::add(glm::vec2 position, glm::vec2 velocity, float radius) {
+  m_positionX.push_back(position.x);
+  m_positionY.push_back(position.y);
+  m_previousX.push_back(position.x);
+  m_previousY.push_back(position.y);
+  m_velocityX.push_back(velocity.x);
+  m_velocityY.push_back(velocity.y);
+  m_radius.push_back(radius);
+}
+
+void BallSet::clear() {
+  m_positionX.clear();
+  m_positionY.clear();
+  m_previousX.clear();
+  m_previousY.clear();
+  m_velocityX.clear();
+  m_velocityY.clear();
+  m_radius.clear();
+}
+
+void BallSet::applyGravity(float gravity, float deltaTime) {
+  auto *velocityY{m_velocityY.data()};
+  auto const count{size()};
+  auto const deltaVelocity{gravity * deltaTime};
+  for (std::size_t i = 0; i < count; ++i) {
+    velocityY[i] -= deltaVelocity;
+  }
+}
+
+// A posição anterior é guardada no mesmo laço, pois o início do passo é o
+// último momento em que ela ainda está disponível
+void BallSet::integrate(float deltaTime) {
+  auto *positionX{m_positionX.data()};
+  auto *positionY{m_positionY.data()};
+  auto *previousX{m_previousX.data()};
+  auto *previousY{m_previousY.data()};
+  auto const *velocityX{m_velocityX.data()};
+  auto const *velocityY{m_velocityY.data()};
+  auto const count{size()};
+  for (std::size_t i = 0; i < count; ++i) {
+    previousX[i] = positionX[i];
+    previousY[i] = positionY[i];
+    positionX[i] += velocityX[i] * deltaTime;
+    positionY[i] += velocityY[i] * deltaTime;
+  }
+}
+
+// Segmentos da mesa, um por vez sobre todas as bolas. A bola que se sobrepõe
+// ao segmento é empurrada para fora ao longo da normal, e a componente da
+// velocidade em direção a ele é refletida. As condições são escritas como
+// máscaras (0 ou 1) multiplicadas, sem desvios, para que o laço seja
+// vetorizado; por exemplo, v -= hit * min(vn, 0) * (1 + e) * n só altera a
+// bola que se aproxima do segmento
+void BallSet::collideSegments(std::span<TableSegment const> segments) {
+  auto *positionX{m_positionX.data()};
+  auto *positionY{m_positionY.data()};
+  auto *velocityX{m_velocityX.data()};
+  auto *velocityY{m_velocityY.data()};
+  auto const *radius{m_radius.data()};
+  auto const count{size()};
+
+  for (auto const &segment : segments) {
+    // Cópias locais: sem elas, o compilador não sabe se as escritas nos
+    // arrays alteram o segmento
+    auto const start{segment.a};
+    auto const edge{segment.b - segment.a};
+    auto const lengthSquared{glm::dot(edge, edge)};
+    auto const inverseLengthSquared{
+        lengthSquared > 0.0f ? 1.0f / lengthSquared : 0.0f};
+    auto const bounce{1.0f + segment.restitution};
+
+    for (std::size_t i = 0; i < count; ++i) {
+      auto const x{positionX[i]};
+      auto const y{positionY[i]};
+      auto const s{std::min(
+          std::max(((x - start.x) * edge.x + (y - start.y) * edge.y) *
+                       inverseLengthSquared,
+                   0.0f),
+          1.0f)};
+      auto const offsetX{x - (start.x + edge.x * s)};
+      auto const offsetY{y - (start.y + edge.y * s)};
+      auto const distanceSquared{offsetX * offsetX + offsetY * offsetY};
+      auto const r{radius[i]};
+      auto const hit{(distanceSquared < r * r ? 1.0f : 0.0f) *
+                     (distanceSquared > 0.0f ? 1.0f : 0.0f)};
+
+      auto const distance{std::sqrt(std::max(distanceSquared, 1e-12f))};
+      auto const normalX{offsetX / distance};
+      auto const normalY{offsetY / distance};
+      auto const push{hit * (r - distance)};
+      positionX[i] = x + normalX * push;
+      positionY[i] = y + normalY * push;
+
+      auto const normalSpeed{velocityX[i] * normalX + velocityY[i] * normalY};
+      auto const impulse{hit * std::min(normalSpeed, 0.0f) * bounce};
+      velocityX[i] -= impulse * normalX;
+      velocityY[i] -= impulse * normalY;
+    }
+  }
+}
+
+// Arcos e bumpers são poucos e exigem o ponto mais próximo de cada elemento;
+// usam o mesmo tratamento dos segmentos, bola a bola
+void BallSet::collideArcs(std::span<TableArc const> arcs) {
+  auto const count{size()};
+  for (auto const &arc : arcs) {
+    for (std::size_t i = 0; i < count; ++i) {
+      glm::vec2 const position{m_positionX[i], m_positionY[i]};
+      if (!Collision::isNearCircle(position, arc.center, arc.radius,
+                                   m_radius[i]))
+        continue;
+      auto const closest{Collision::closestPointOnArc(
+          position, arc.center, arc.radius, arc.startAngle, arc.endAngle)};
+      pushOut(i, closest, m_radius[i], arc.restitution);
+    }
+  }
+}
+
+void BallSet::collideBumpers(std::span<TableBumper const> bumpers) {
+  auto const count{size()};
+  for (auto const &bumper : bumpers) {
+    for (std::size_t i = 0; i < count; ++i) {
+      pushOut(i, bumper.position, m_radius[i] + bumper.radius,
+              bumper.restitution);
+    }
+  }
+}
+
+// Colisão discreta com um flipper, tratado como cápsula na posição atual
+void BallSet::collideFlipper(Flipper const &flipper, bool isLeft) {
+  auto const angle{isLeft ? flipper.currentAngle
+                          : static_cast<float>(M_PI) - flipper.currentAngle};
+  auto const angularVelocity{isLeft ? flipper.angularVelocity
+                                    : -flipper.angularVelocity};
+  glm::vec2 const pivot{flipper.position};
+  glm::vec2 const edge{flipper.length * glm::vec2{std::cos(angle),
+                                                  std::sin(angle)}};
+  auto const edgeLengthSquared{glm::dot(edge, edge)};
+
+  auto const count{size()};
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::vec2 const position{m_positionX[i], m_positionY[i]};
+    auto const s{std::clamp(glm::dot(position - pivot, edge) /
+                                edgeLengthSquared,
+                            0.0f, 1.0f)};
+    auto const arm{edge * s};
+    auto const offset{position - pivot - arm};
+    auto const minDistance{m_radius[i] + flipper.radius};
+    auto const distanceSquared{glm::dot(offset, offset)};
+    if (distanceSquared >= minDistance * minDistance ||
+        distanceSquared <= 0.0f)
+      continue;
+
+    // Empurra a bola para fora e reflete a velocidade relativa ao ponto de
+    // contato, com a restituição e o atrito do flipper
+    auto const distance{std::sqrt(distanceSquared)};
+    auto const normal{offset / distance};
+    auto const corrected{position + normal * (minDistance - distance)};
+    m_positionX[i] = corrected.x;
+    m_positionY[i] = corrected.y;
+
+    glm::vec2 const surfaceVelocity{angularVelocity *
+                                    glm::vec2{-arm.y, arm.x}};
+    auto const resolved{Collision::resolveVelocity(
+        {m_velocityX[i], m_velocityY[i]}, normal, surfaceVelocity,
+        flipper.restitution, flipper.friction)};
+    m_velocityX[i] = resolved.x;
+    m_velocityY[i] = resolved.y;
+  }
+}
+
+void BallSet::collideObstacles(std::vector<Obstacle> const &obstacles,
+                               SpatialGrid const &grid) {
+  auto const count{size()};
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::vec2 position{m_positionX[i], m_positionY[i]};
+    auto const radius{m_radius[i]};
+
+    m_candidates.clear();
+    grid.query(position - radius, position + radius, m_candidates);
+
+    for (auto const index : m_candidates) {
+      auto const &obstacle{obstacles[index]};
+      auto const offset{position - obstacle.position};
+      auto const minDistance{radius + obstacle.collisionRadius()};
+      auto const distanceSquared{glm::dot(offset, offset)};
+      if (distanceSquared >= minDistance * minDistance ||
+          distanceSquared <= 0.0f)
+        continue;
+
+      auto const distance{std::sqrt(distanceSquared)};
+      auto const normal{offset / distance};
+      position += normal * (minDistance - distance);
+
+      glm::vec2 const velocity{m_velocityX[i], m_velocityY[i]};
+      if (auto const normalSpeed{glm::dot(velocity, normal)};
+          normalSpeed < 0.0f) {
+        auto const reflected{velocity - 2.0f * normalSpeed * normal};
+        m_velocityX[i] = reflected.x;
+        m_velocityY[i] = reflected.y;
+      }
+    }
+
+    m_positionX[i] = position.x;
+    m_positionY[i] = position.y;
+  }
+}
+
+// Colisões entre bolas. As bolas são distribuídas em uma grade com células do
+// tamanho do maior diâmetro (ordenação por contagem), e cada bola só é testada
+// contra as bolas das oito células vizinhas, o que mantém o custo linear
+void BallSet::collideBalls() {
+  auto const count{size()};
+  if (count < 2)
+    return;
+
+  // Limites das bolas, em um laço que o compilador consegue vetorizar
+  glm::vec2 min{m_positionX[0], m_positionY[0]};
+  glm::vec2 max{min};
+  auto maxRadius{0.0f};
+  for (std::size_t i = 0; i < count; ++i) {
+    min.x = std::min(min.x, m_positionX[i]);
+    min.y = std::min(min.y, m_positionY[i]);
+    max.x = std::max(max.x, m_positionX[i]);
+    max.y = std::max(max.y, m_positionY[i]);
+    maxRadius = std::max(maxRadius, m_radius[i]);
+  }
+  glm::vec2 const origin{min};
+  glm::vec2 const extent{max - min};
+
+  // Limita o número de células a algumas vezes o número de bolas
+  auto cellSize{std::max(2.0f * maxRadius, 1e-4f)};
+  auto const maxCells{4.0f * static_cast<float>(count) + 16.0f};
+  if (auto const cells{(extent.x / cellSize + 1.0f) *
+                       (extent.y / cellSize + 1.0f)};
+      cells > maxCells) {
+    cellSize *= std::sqrt(cells / maxCells);
+  }
+  auto const columns{static_cast<int>(extent.x / cellSize) + 1};
+  auto const rows{static_cast<int>(extent.y / cellSize) + 1};
+  auto const numCells{static_cast<std::size_t>(columns * rows)};
+
+  auto cellOf = [&](std::size_t i) {
+    auto const column{static_cast<int>((m_positionX[i] - origin.x) / cellSize)};
+    auto const row{static_cast<int>((m_positionY[i] - origin.y) / cellSize)};
+    return glm::ivec2{std::min(column, columns - 1), std::min(row, rows - 1)};
+  };
+
+  // Ordenação por contagem das bolas por célula
+  m_cellStart.assign(numCells + 1, 0);
+  m_ballCell.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const cell{cellOf(i)};
+    m_ballCell[i] = static_cast<std::uint32_t>(cell.y * columns + cell.x);
+    ++m_cellStart[m_ballCell[i] + 1];
+  }
+  for (std::size_t cell = 0; cell < numCells; ++cell) {
+    m_cellStart[cell + 1] += m_cellStart[cell];
+  }
+  m_cellBalls.resize(count);
+  m_candidates.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    m_cellBalls[m_candidates[m_ballCell[i]]++] = i;
+  }
+
+  // Reordena os arrays na ordem das células, de modo que as bolas vizinhas
+  // fiquem próximas na memória e cada célula seja um intervalo contíguo
+  auto reorder = [&](FloatArray &array) {
+    m_scratch.resize(count);
+    for (std::size_t k = 0; k < count; ++k) {
+      m_scratch[k] = array[m_cellBalls[k]];
+    }
+    array.swap(m_scratch);
+  };
+  reorder(m_positionX);
+  reorder(m_positionY);
+  reorder(m_previousX);
+  reorder(m_previousY);
+  reorder(m_velocityX);
+  reorder(m_velocityY);
+  reorder(m_radius);
+  for (std::size_t cell = 0; cell < numCells; ++cell) {
+    std::fill(m_ballCell.begin() + m_cellStart[cell],
+              m_ballCell.begin() + m_cellStart[cell + 1],
+              static_cast<std::uint32_t>(cell));
+  }
+
+  auto const restitution{0.9f};
+  auto collidePair = [&](std::size_t i, std::size_t j) {
+    glm::vec2 const offset{m_positionX[j] - m_positionX[i],
+                           m_positionY[j] - m_positionY[i]};
+    auto const minDistance{m_radius[i] + m_radius[j]};
+    auto const distanceSquared{glm::dot(offset, offset)};
+    if (distanceSquared >= minDistance * minDistance ||
+        distanceSquared <= 0.0f)
+      return;
+
+    // Separa as bolas igualmente ao longo da normal
+    auto const distance{std::sqrt(distanceSquared)};
+    auto const normal{offset / distance};
+    auto const correction{0.5f * (minDistance - distance) * normal};
+    m_positionX[i] -= correction.x;
+    m_positionY[i] -= correction.y;
+    m_positionX[j] += correction.x;
+    m_positionY[j] += correction.y;
+
+    // Impulso entre bolas de mesma massa
+    glm::vec2 const relative{m_velocityX[j] - m_velocityX[i],
+                             m_velocityY[j] - m_velocityY[i]};
+    auto const normalSpeed{glm::dot(relative, normal)};
+    if (normalSpeed >= 0.0f)
+      return;
+    auto const impulse{-0.5f * (1.0f + restitution) * normalSpeed * normal};
+    m_velocityX[i] -= impulse.x;
+    m_velocityY[i] -= impulse.y;
+    m_velocityX[j] += impulse.x;
+    m_velocityY[j] += impulse.y;
+  };
+
+  // Como as células estão em ordem de linha, cada par é testado uma única
+  // vez percorrendo apenas a metade "posterior" da vizinhança: o restante da
+  // própria célula e a célula à direita, e as três células da linha de cima.
+  // Células consecutivas de uma linha formam um intervalo contíguo de bolas
+  auto cellIndex = [columns](int column, int row) {
+    return static_cast<std::size_t>(row * columns + column);
+  };
+  for (std::size_t i = 0; i < count; ++i) {
+    auto const column{static_cast<int>(m_ballCell[i]) % columns};
+    auto const row{static_cast<int>(m_ballCell[i]) / columns};
+    auto const lastColumn{std::min(column + 1, columns - 1)};
+
+    auto const end{m_cellStart[cellIndex(lastColumn, row) + 1]};
+    for (auto j{i + 1}; j < end; ++j) {
+      collidePair(i, j);
+    }
+
+    if (row + 1 < rows) {
+      auto const firstColumn{std::max(column - 1, 0)};
+      auto const begin{m_cellStart[cellIndex(firstColumn, row + 1)]};
+      auto const end{m_cellStart[cellIndex(lastColumn, row + 1) + 1]};
+      for (auto j{begin}; j < end; ++j) {
+        collidePair(i, j);
+      }
+    }
+  }
+}
+
+std::size_t BallSet::removeDrained(float bottom) {
+  std::size_t removed{};
+  for (std::size_t i = 0; i < size();) {
+    if (m_positionY[i] - m_radius[i] < bottom) {
+      remove(i);
+      ++removed;
+    } else {
+      ++i;
+    }
+  }
+  return removed;
+}
+
+// Afasta a bola index até minDistance de closest e reflete a componente da
+// velocidade em direção a ele
+void BallSet::pushOut(std::size_t index, glm::vec2 closest, float minDistance,
+                      float restitution) {
+  glm::vec2 const position{m_positionX[index], m_positionY[index]};
+  auto const offset{position - closest};
+  auto const distanceSquared{glm::dot(offset, offset)};
+  if (distanceSquared >= minDistance * minDistance || distanceSquared <= 0.0f)
+    return;
+
+  auto const normal{offset / std::sqrt(distanceSquared)};
+  auto const corrected{closest + normal * minDistance};
+  m_positionX[index] = corrected.x;
+  m_positionY[index] = corrected.y;
+
+  glm::vec2 const velocity{m_velocityX[index], m_velocityY[index]};
+  if (auto const normalSpeed{glm::dot(velocity, normal)}; normalSpeed < 0.0f) {
+    auto const reflected{velocity -
+                         (1.0f + restitution) * normalSpeed * normal};
+    m_velocityX[index] = reflected.x;
+    m_velocityY[index] = reflected.y;
+  }
+}
+
+// Remove trocando com a última bola (a ordem das bolas não importa)
+void BallSet::remove(std::size_t index) {
+  auto swapRemove = [index](FloatArray &array) {
+    array[index] = array.back();
+    array.pop_back();
+  };
+  swapRemove(m_positionX);
+  swapRemove(m_positionY);
+  swapRemove(m_previousX);
+  swapRemove(m_previousY);
+  swapRemove(m_velocityX);
+  swapRemove(m_velocityY);
+  swapRemove(m_radius);
+}
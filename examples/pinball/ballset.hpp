@@ -0,0 +1,99 @@
+#ifndef BALLSET_HPP_
+#define BALLSET_HPP_
+
+#include "gamedata.hpp"
+#include "spatialgrid.hpp"
+#include "table.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <new>
+#include <span>
+#include <vector>
+
+// Alocador com alinhamento de 32 bytes (um registrador AVX), para que os
+// laços sobre os arrays da BallSet possam ser vetorizados pelo compilador
+template <typename T> struct AlignedAllocator {
+  using value_type = T;
+  static constexpr std::align_val_t alignment{32};
+
+  AlignedAllocator() noexcept = default;
+  template <typename U>
+  explicit AlignedAllocator(AlignedAllocator<U> const & /*unused*/) noexcept {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(::operator new(n * sizeof(T), alignment));
+  }
+  void deallocate(T *pointer, std::size_t /*unused*/) noexcept {
+    ::operator delete(pointer, alignment);
+  }
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U>;
+  };
+
+  bool operator==(AlignedAllocator const & /*unused*/) const noexcept {
+    return true;
+  }
+};
+
+using FloatArray = std::vector<float, AlignedAllocator<float>>;
+
+// Conjunto de bolas do modo multibola, armazenado como estrutura de arrays
+// (SoA). Ao contrário de Ball, o raio já está em coordenadas do mundo
+// (multiplicado por GAME_SCALE).
+class BallSet {
+public:
+  void add(glm::vec2 position, glm::vec2 velocity, float radius);
+  void clear();
+  [[nodiscard]] std::size_t size() const noexcept { return m_positionX.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_positionX.empty(); }
+
+  [[nodiscard]] glm::vec2 getPosition(std::size_t index) const {
+    return {m_positionX[index], m_positionY[index]};
+  }
+  // Posição no início do último passo, usada para interpolar a renderização
+  [[nodiscard]] glm::vec2 getPreviousPosition(std::size_t index) const {
+    return {m_previousX[index], m_previousY[index]};
+  }
+  [[nodiscard]] float getRadius(std::size_t index) const {
+    return m_radius[index];
+  }
+
+  // Núcleos vetorizáveis: um laço simples por array, sem desvios
+  void applyGravity(float gravity, float deltaTime);
+  void integrate(float deltaTime);
+  void collideSegments(std::span<TableSegment const> segments);
+
+  void collideArcs(std::span<TableArc const> arcs);
+  void collideBumpers(std::span<TableBumper const> bumpers);
+  void collideFlipper(Flipper const &flipper, bool isLeft);
+  void collideObstacles(std::vector<Obstacle> const &obstacles,
+                        SpatialGrid const &grid);
+  void collideBalls();
+
+  // Remove as bolas que caíram abaixo de bottom; retorna quantas saíram
+  std::size_t removeDrained(float bottom);
+
+private:
+  void remove(std::size_t index);
+  void pushOut(std::size_t index, glm::vec2 closest, float minDistance,
+               float restitution);
+
+  FloatArray m_positionX;
+  FloatArray m_positionY;
+  FloatArray m_previousX;
+  FloatArray m_previousY;
+  FloatArray m_velocityX;
+  FloatArray m_velocityY;
+  FloatArray m_radius;
+
+  // Grade das bolas, reconstruída a cada passo para as colisões entre bolas
+  std::vector<std::uint32_t> m_cellStart;
+  std::vector<std::uint32_t> m_cellBalls;
+  std::vector<std::uint32_t> m_ballCell;
+  std::vector<std::uint32_t> m_candidates;
+  FloatArray m_scratch;
+};
+
+#endif
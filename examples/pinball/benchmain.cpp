@@ -0,0 +1,34 @@
+// pinball_bench: microbenchmarks da física, do histórico de sessões e da
+// renderização do pinball.
+//
+//   pinball_bench [--filter TEXTO] [--json ARQUIVO] [--min-time S]
+//                 [--repetitions N] [--list]
+//
+// Cada linha mostra a mediana e o desvio padrão do tempo por iteração, o
+// número de iterações por repetição e, quando faz sentido, a vazão. Com
+// --json, os resultados são gravados para comparação entre versões.
+
+#include "benchmark.hpp"
+#include "benchsuites.hpp"
+
+#include <span>
+
+int main(int argc, char **argv) {
+  try {
+    bench::Runner runner;
+    runner.parseArguments(std::span{argv, static_cast<std::size_t>(argc)});
+
+    registerPhysicsBenchmarks(runner);
+    registerStoreBenchmarks(runner);
+    runner.run();
+#if defined(PINBALL_BENCH_RENDER)
+    runRenderBenchmarks(runner, argc, argv);
+#endif
+
+    runner.writeJSON("pinball_bench");
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
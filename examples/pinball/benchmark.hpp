@@ -0,0 +1,289 @@
+#ifndef BENCHMARK_HPP_
+#define BENCHMARK_HPP_
+
+// Harness mínimo de microbenchmarks, só com cabeçalho, usado pelo
+// pinball_bench.
+//
+// Cada benchmark é registrado com uma lista de parâmetros (número de
+// obstáculos, de bolas, de chamadas de desenho...) e executado uma vez por
+// parâmetro. O número de iterações é calibrado até que uma repetição dure
+// pelo menos minTime; o resultado é a mediana das repetições, em
+// nanossegundos por iteração. Os resultados podem ser gravados em JSON para
+// comparar versões.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fmt/core.h>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+// Impede que o compilador descarte um resultado não usado
+template <typename T> inline void doNotOptimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static_cast<void>(*static_cast<T const volatile *>(&value));
+#endif
+}
+
+// Estado passado a cada execução de um benchmark. Uso:
+//
+//   // preparação (não medida)
+//   while (state.next()) {
+//     // código medido
+//   }
+class State {
+public:
+  State(std::int64_t param, std::uint64_t iterations)
+      : m_param{param}, m_remaining{iterations}, m_iterations{iterations} {}
+
+  [[nodiscard]] std::int64_t param() const noexcept { return m_param; }
+
+  bool next() {
+    if (!m_running) {
+      m_running = true;
+      m_start = Clock::now();
+    }
+    if (m_remaining == 0) {
+      stop();
+      return false;
+    }
+    --m_remaining;
+    return true;
+  }
+
+  // Exclui da medição um trecho dentro do laço
+  void pauseTiming() { m_elapsed += Clock::now() - m_start; }
+  void resumeTiming() { m_start = Clock::now(); }
+
+  // Itens processados por iteração, para calcular a vazão (itens/s)
+  void setItemsPerIteration(double items) noexcept { m_items = items; }
+
+  [[nodiscard]] std::uint64_t iterations() const noexcept {
+    return m_iterations;
+  }
+  [[nodiscard]] double elapsedSeconds() const noexcept {
+    return std::chrono::duration<double>(m_elapsed).count();
+  }
+  [[nodiscard]] double itemsPerIteration() const noexcept { return m_items; }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::int64_t m_param;
+  std::uint64_t m_remaining;
+  std::uint64_t m_iterations;
+  bool m_running{};
+  Clock::time_point m_start;
+  Clock::duration m_elapsed{};
+  double m_items{};
+
+  void stop() {
+    if (m_running)
+      m_elapsed += Clock::now() - m_start;
+    m_running = false;
+  }
+};
+
+struct Result {
+  std::string name;
+  std::int64_t param{};
+  std::uint64_t iterations{};
+  int repetitions{};
+  double medianNs{};
+  double minNs{};
+  double stddevNs{};
+  double itemsPerSecond{};
+};
+
+struct Settings {
+  double minTime{0.1};
+  int repetitions{5};
+  std::string filter;
+  std::string jsonPath;
+  bool list{};
+};
+
+class Runner {
+public:
+  using Function = std::function<void(State &)>;
+
+  void add(std::string name, std::vector<std::int64_t> params,
+           Function function) {
+    m_benchmarks.push_back(
+        {std::move(name), std::move(params), std::move(function)});
+  }
+
+  // Lê --filter, --json, --min-time, --repetitions e --list
+  void parseArguments(std::span<char *> args) {
+    for (std::size_t i = 1; i < args.size(); ++i) {
+      std::string_view const arg{args[i]};
+      if (arg == "--list") {
+        m_settings.list = true;
+        continue;
+      }
+      if (i + 1 >= args.size())
+        throw std::runtime_error(fmt::format("Missing value for {}", arg));
+      std::string const value{args[++i]};
+      if (arg == "--filter")
+        m_settings.filter = value;
+      else if (arg == "--json")
+        m_settings.jsonPath = value;
+      else if (arg == "--min-time")
+        m_settings.minTime = std::stod(value);
+      else if (arg == "--repetitions")
+        m_settings.repetitions = std::max(std::stoi(value), 1);
+      else
+        throw std::runtime_error(fmt::format("Unknown option: {}", arg));
+    }
+  }
+
+  [[nodiscard]] Settings const &getSettings() const noexcept {
+    return m_settings;
+  }
+
+  // Executa os benchmarks registrados que passam pelo filtro
+  void run() {
+    for (auto const &benchmark : m_benchmarks) {
+      for (auto const param : benchmark.params) {
+        auto const name{fmt::format("{}/{}", benchmark.name, param)};
+        if (name.find(m_settings.filter) == std::string::npos)
+          continue;
+        if (m_settings.list) {
+          fmt::print("{}\n", name);
+          continue;
+        }
+        m_results.push_back(measure(benchmark, param));
+        print(m_results.back());
+      }
+    }
+    m_benchmarks.clear();
+  }
+
+  // Grava todos os resultados em JSON, se --json foi dado
+  void writeJSON(std::string_view executable) const {
+    if (m_settings.jsonPath.empty() || m_settings.list)
+      return;
+
+    std::ofstream file(m_settings.jsonPath);
+    auto const now{std::time(nullptr)};
+    std::array<char, 32> date{};
+    std::strftime(date.data(), date.size(), "%Y-%m-%dT%H:%M:%SZ",
+                  std::gmtime(&now));
+
+    file << "{\n  \"context\": {\n";
+    file << fmt::format("    \"date\": \"{}\",\n", date.data());
+    file << fmt::format("    \"executable\": \"{}\",\n", executable);
+    file << fmt::format("    \"num_cpus\": {},\n",
+                        std::thread::hardware_concurrency());
+    file << fmt::format("    \"min_time\": {},\n", m_settings.minTime);
+    file << fmt::format("    \"repetitions\": {}\n", m_settings.repetitions);
+    file << "  },\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < m_results.size(); ++i) {
+      auto const &result{m_results[i]};
+      file << (i == 0 ? "\n" : ",\n");
+      file << fmt::format(
+          "    {{\"name\": \"{}/{}\", \"family\": \"{}\", \"param\": {}, "
+          "\"iterations\": {}, \"repetitions\": {}, \"median_ns\": {:.3f}, "
+          "\"min_ns\": {:.3f}, \"stddev_ns\": {:.3f}, "
+          "\"items_per_second\": {:.3f}}}",
+          result.name, result.param, result.name, result.param,
+          result.iterations, result.repetitions, result.medianNs,
+          result.minNs, result.stddevNs, result.itemsPerSecond);
+    }
+    file << "\n  ]\n}\n";
+
+    if (!file)
+      throw std::runtime_error(
+          fmt::format("Failed to write {}", m_settings.jsonPath));
+  }
+
+private:
+  struct Benchmark {
+    std::string name;
+    std::vector<std::int64_t> params;
+    Function function;
+  };
+
+  Settings m_settings;
+  std::vector<Benchmark> m_benchmarks;
+  std::vector<Result> m_results;
+
+  Result measure(Benchmark const &benchmark, std::int64_t param) const {
+    // Dobra as iterações (ou estima pelo tempo medido) até atingir minTime
+    std::uint64_t iterations{1};
+    while (true) {
+      State state{param, iterations};
+      benchmark.function(state);
+      auto const elapsed{state.elapsedSeconds()};
+      if (elapsed >= m_settings.minTime || iterations >= (1ULL << 40))
+        break;
+      auto const estimate{elapsed > 0.0
+                              ? m_settings.minTime / elapsed * 1.2 *
+                                    static_cast<double>(iterations)
+                              : static_cast<double>(iterations) * 10.0};
+      iterations = std::clamp(static_cast<std::uint64_t>(estimate),
+                              iterations * 2, iterations * 100);
+    }
+
+    std::vector<double> samples;
+    double items{};
+    for (int repetition = 0; repetition < m_settings.repetitions;
+         ++repetition) {
+      State state{param, iterations};
+      benchmark.function(state);
+      samples.push_back(state.elapsedSeconds() * 1e9 /
+                        static_cast<double>(iterations));
+      items = state.itemsPerIteration();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto const count{static_cast<double>(samples.size())};
+    auto const middle{samples.size() / 2};
+    auto const median{samples.size() % 2 == 1
+                          ? samples[middle]
+                          : (samples[middle - 1] + samples[middle]) / 2.0};
+    double mean{};
+    for (auto const sample : samples) {
+      mean += sample / count;
+    }
+    double variance{};
+    for (auto const sample : samples) {
+      variance += (sample - mean) * (sample - mean) / count;
+    }
+
+    return {.name = benchmark.name,
+            .param = param,
+            .iterations = iterations,
+            .repetitions = m_settings.repetitions,
+            .medianNs = median,
+            .minNs = samples.front(),
+            .stddevNs = std::sqrt(variance),
+            .itemsPerSecond = median > 0.0 ? items * 1e9 / median : 0.0};
+  }
+
+  static void print(Result const &result) {
+    auto const name{fmt::format("{}/{}", result.name, result.param)};
+    fmt::print("{:<48} {:>12.1f} ns {:>9.1f} ns {:>12}", name, result.medianNs,
+               result.stddevNs, result.iterations);
+    if (result.itemsPerSecond > 0.0)
+      fmt::print(" {:>12.3e} items/s", result.itemsPerSecond);
+    fmt::print("\n");
+  }
+};
+
+} // namespace bench
+
+#endif
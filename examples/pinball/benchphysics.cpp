@@ -0,0 +1,224 @@
+#include "benchmark.hpp"
+#include "benchsuites.hpp"
+#include "collision.hpp"
+#include "simulation.hpp"
+#include "spatialgrid.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+// Estados da bola espalhados pela mesa, reaproveitados em rodízio pelos
+// benchmarks que testam uma consulta isolada
+struct BallSample {
+  glm::vec2 position;
+  glm::vec2 velocity;
+};
+
+std::vector<BallSample> makeSamples(std::size_t count) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> position{-0.95f, 0.95f};
+  std::uniform_real_distribution<float> velocity{-3.0f, 3.0f};
+
+  std::vector<BallSample> samples(count);
+  for (auto &sample : samples) {
+    sample = {{position(gen), position(gen)}, {velocity(gen), velocity(gen)}};
+  }
+  return samples;
+}
+
+Simulation makeSimulation(int obstacles) {
+  Simulation simulation;
+  simulation.generateObstacles(1, LayoutSettings{.count = obstacles});
+  return simulation;
+}
+
+} // namespace
+
+// Chama as etapas privadas da Simulation (friend)
+struct SimulationBenchmark {
+  static void setBall(Simulation &simulation, BallSample const &sample) {
+    simulation.m_ball.position = sample.position;
+    simulation.m_ball.velocity = sample.velocity;
+  }
+
+  static void checkCollisionWithObstacles(bench::State &state) {
+    auto simulation{makeSimulation(static_cast<int>(state.param()))};
+    auto const samples{makeSamples(1024)};
+
+    std::size_t index{};
+    while (state.next()) {
+      setBall(simulation, samples[index++ % samples.size()]);
+      Simulation::Contact contact{.time = simulation.m_timestep.getStep()};
+      simulation.checkCollisionWithObstacles(contact);
+      bench::doNotOptimize(contact);
+    }
+  }
+
+  static void checkCollisionWithTable(bench::State &state) {
+    auto simulation{makeSimulation(6)};
+    auto const samples{makeSamples(1024)};
+
+    std::size_t index{};
+    while (state.next()) {
+      setBall(simulation, samples[index++ % samples.size()]);
+      Simulation::Contact contact{.time = simulation.m_timestep.getStep()};
+      simulation.checkCollisionWithTable(contact);
+      bench::doNotOptimize(contact);
+    }
+  }
+
+  static void checkCollisionWithFlippers(bench::State &state) {
+    auto simulation{makeSimulation(6)};
+    auto const samples{makeSamples(1024)};
+
+    std::size_t index{};
+    while (state.next()) {
+      setBall(simulation, samples[index++ % samples.size()]);
+      Simulation::Contact contact{.time = simulation.m_timestep.getStep()};
+      simulation.checkCollisionWithFlippers(contact, 0.0f);
+      bench::doNotOptimize(contact);
+    }
+  }
+
+  static void resolveTableOverlaps(bench::State &state) {
+    auto simulation{makeSimulation(6)};
+    auto const samples{makeSamples(1024)};
+
+    std::size_t index{};
+    while (state.next()) {
+      setBall(simulation, samples[index++ % samples.size()]);
+      simulation.resolveTableOverlaps();
+      bench::doNotOptimize(simulation.m_ball);
+    }
+  }
+
+  static void checkCollisions(bench::State &state) {
+    auto simulation{makeSimulation(6)};
+    auto const samples{makeSamples(1024)};
+
+    std::size_t index{};
+    while (state.next()) {
+      setBall(simulation, samples[index++ % samples.size()]);
+      simulation.checkCollisions();
+      bench::doNotOptimize(simulation.m_ball);
+    }
+  }
+
+  static void stepMultiBalls(Simulation &simulation, float deltaTime) {
+    simulation.stepMultiBalls(deltaTime);
+  }
+
+  static void collideBalls(Simulation &simulation) {
+    simulation.m_multiBalls.collideBalls();
+  }
+
+  // Multibola com param bolas; repõe as bolas quando metade já caiu
+  template <typename Step>
+  static void multiBall(bench::State &state, Step const &step) {
+    auto simulation{makeSimulation(6)};
+    auto const count{static_cast<int>(state.param())};
+    simulation.setMultiBallCount(count);
+    simulation.handleInput(Simulation::Input::MultiBall);
+
+    auto const deltaTime{simulation.m_timestep.getStep()};
+    auto const refillBelow{static_cast<std::size_t>(count / 2)};
+    state.setItemsPerIteration(static_cast<double>(count));
+    while (state.next()) {
+      if (simulation.m_multiBalls.size() < refillBelow) {
+        state.pauseTiming();
+        simulation.m_multiBalls.clear();
+        simulation.startMultiBall();
+        state.resumeTiming();
+      }
+      step(simulation, deltaTime);
+    }
+  }
+};
+
+void registerPhysicsBenchmarks(bench::Runner &runner) {
+  runner.add("Simulation/checkCollisionWithObstacles", {6, 32, 128, 512},
+             SimulationBenchmark::checkCollisionWithObstacles);
+  runner.add("Simulation/checkCollisionWithTable", {1},
+             SimulationBenchmark::checkCollisionWithTable);
+  runner.add("Simulation/checkCollisionWithFlippers", {1},
+             SimulationBenchmark::checkCollisionWithFlippers);
+  runner.add("Simulation/resolveTableOverlaps", {1},
+             SimulationBenchmark::resolveTableOverlaps);
+  runner.add("Simulation/checkCollisions", {1},
+             SimulationBenchmark::checkCollisions);
+
+  // Um passo fixo completo, com param obstáculos
+  runner.add("Simulation/step", {0, 6, 32, 128}, [](bench::State &state) {
+    auto simulation{makeSimulation(static_cast<int>(state.param()))};
+    while (state.next()) {
+      if (!simulation.isStarted())
+        simulation.handleInput(Simulation::Input::Launch);
+      simulation.step();
+    }
+    bench::doNotOptimize(simulation.getBall());
+  });
+
+  // Um frame de 60 Hz com param passos por segundo
+  runner.add("Simulation/frameAtTickRate", {240, 500, 1000, 2000, 4000},
+             [](bench::State &state) {
+               auto simulation{makeSimulation(6)};
+               simulation.getTimestep().setTickRate(
+                   static_cast<double>(state.param()));
+               while (state.next()) {
+                 if (!simulation.isStarted())
+                   simulation.handleInput(Simulation::Input::Launch);
+                 simulation.update(1.0 / 60.0);
+               }
+               bench::doNotOptimize(simulation.getBall());
+             });
+
+  runner.add("MultiBall/step", {64, 1024, 8192}, [](bench::State &state) {
+    SimulationBenchmark::multiBall(
+        state, [](Simulation &simulation, float deltaTime) {
+          SimulationBenchmark::stepMultiBalls(simulation, deltaTime);
+        });
+  });
+  runner.add("MultiBall/collideBalls", {64, 1024, 8192},
+             [](bench::State &state) {
+               SimulationBenchmark::multiBall(
+                   state, [](Simulation &simulation, float /*deltaTime*/) {
+                     SimulationBenchmark::collideBalls(simulation);
+                   });
+             });
+
+  runner.add("SpatialGrid/query", {6, 32, 128, 512}, [](bench::State &state) {
+    auto const simulation{makeSimulation(static_cast<int>(state.param()))};
+    SpatialGrid grid;
+    grid.build(simulation.getObstacles());
+    auto const samples{makeSamples(1024)};
+
+    std::vector<std::uint32_t> candidates;
+    std::size_t index{};
+    while (state.next()) {
+      auto const &sample{samples[index++ % samples.size()]};
+      candidates.clear();
+      grid.query(sample.position - 0.05f, sample.position + 0.05f, candidates);
+      bench::doNotOptimize(candidates.data());
+    }
+  });
+
+  runner.add("Collision/sweepCircleRotatingCapsule", {1},
+             [](bench::State &state) {
+               auto const samples{makeSamples(1024)};
+               RotatingCapsule const capsule{.pivot = {-0.5f, -0.8f},
+                                             .length = 0.4f,
+                                             .radius = 0.025f,
+                                             .angle = -0.3f,
+                                             .angularVelocity = 5.0f};
+               std::size_t index{};
+               while (state.next()) {
+                 auto const &sample{samples[index++ % samples.size()]};
+                 auto const time{Collision::sweepCircleRotatingCapsule(
+                     sample.position, sample.velocity, 0.03f, capsule,
+                     0.001f)};
+                 bench::doNotOptimize(time);
+               }
+             });
+}
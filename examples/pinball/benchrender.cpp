@@ -0,0 +1,186 @@
+#include "benchmark.hpp"
+#include "benchsuites.hpp"
+#include "render.hpp"
+#include "window.hpp"
+
+// Mede as rotinas de desenho em uma janela oculta. O jogo é desenhado em um
+// framebuffer próprio, fora da tela, e cada iteração termina com glFinish para
+// que o tempo medido inclua a execução na GPU, e não só o envio dos comandos.
+class RenderBenchmark final : public abcg::OpenGLWindow {
+public:
+  explicit RenderBenchmark(bench::Runner &runner) : m_runner{runner} {}
+
+private:
+  static constexpr int width{600};
+  static constexpr int height{800};
+
+  bench::Runner &m_runner;
+  ::Window m_game;
+  GLuint m_framebuffer{};
+  GLuint m_renderbuffer{};
+  bool m_done{};
+
+  void onCreate() override;
+  void onUpdate() override;
+  void onDestroy() override;
+
+  void registerBenchmarks();
+  // Grava count chamadas de draw por iteração e executa a lista de desenho
+  template <typename Draw>
+  void addDrawBenchmark(std::string name, std::vector<std::int64_t> params,
+                        Draw draw);
+};
+
+void RenderBenchmark::onCreate() {
+  m_game.onCreate();
+  m_game.onResize({width, height});
+
+  glGenRenderbuffers(1, &m_renderbuffer);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_renderbuffer);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+  glGenFramebuffers(1, &m_framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                            GL_RENDERBUFFER, m_renderbuffer);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    throw abcg::RuntimeError("Failed to create the benchmark framebuffer");
+  glViewport(0, 0, width, height);
+}
+
+// onUpdate é chamado mesmo com a janela oculta, ao contrário de onPaint
+void RenderBenchmark::onUpdate() {
+  if (m_done)
+    return;
+  m_done = true;
+
+  registerBenchmarks();
+  m_runner.run();
+
+  SDL_Event quit{};
+  quit.type = SDL_QUIT;
+  SDL_PushEvent(&quit);
+}
+
+void RenderBenchmark::onDestroy() {
+  m_game.onDestroy();
+
+  if (m_framebuffer != 0)
+    glDeleteFramebuffers(1, &m_framebuffer);
+  if (m_renderbuffer != 0)
+    glDeleteRenderbuffers(1, &m_renderbuffer);
+}
+
+template <typename Draw>
+void RenderBenchmark::addDrawBenchmark(std::string name,
+                                       std::vector<std::int64_t> params,
+                                       Draw draw) {
+  m_runner.add(std::move(name), std::move(params),
+               [this, draw](bench::State &state) {
+                 auto const count{state.param()};
+                 state.setItemsPerIteration(static_cast<double>(count));
+                 while (state.next()) {
+                   glClear(GL_COLOR_BUFFER_BIT);
+                   for (std::int64_t i = 0; i < count; ++i) {
+                     draw();
+                   }
+                   m_game.m_drawList.flush();
+                   glFinish();
+                 }
+               });
+}
+
+void RenderBenchmark::registerBenchmarks() {
+  auto &game{m_game};
+  auto &simulation{game.m_simulation};
+  std::vector<std::int64_t> const drawCalls{1, 16, 256};
+
+  addDrawBenchmark("Render/renderFlipper", drawCalls, [&game, &simulation] {
+    Render::renderFlipper(game, simulation.getLeftFlipper(), true);
+  });
+  addDrawBenchmark("Render/renderTable", drawCalls,
+                   [&game] { Render::renderTable(game); });
+
+  // Todos os obstáculos ou todas as bolas em uma única chamada instanciada;
+  // o tempo por item deve cair com param. renderObstacles é o custo de
+  // redesenhar a camada estática, que só ocorre quando o layout muda
+  m_runner.add("Render/renderObstacles", {6, 1024, 10000},
+               [&game, &simulation](bench::State &state) {
+                 simulation.generateObstacles(
+                     1, LayoutSettings{
+                            .count = static_cast<int>(state.param())});
+                 state.setItemsPerIteration(
+                     static_cast<double>(state.param()));
+                 game.updateFrame();
+                 while (state.next()) {
+                   glClear(GL_COLOR_BUFFER_BIT);
+                   Render::renderObstacles(game);
+                   game.m_drawList.flush();
+                   glFinish();
+                 }
+                 simulation.generateObstacles(1);
+               });
+  m_runner.add("Render/renderBalls", {64, 1024},
+               [&game, &simulation](bench::State &state) {
+                 simulation.reset();
+                 simulation.setMultiBallCount(
+                     static_cast<int>(state.param()));
+                 simulation.handleInput(Simulation::Input::MultiBall);
+                 state.setItemsPerIteration(
+                     static_cast<double>(simulation.getMultiBalls().size()));
+                 game.updateFrame();
+                 while (state.next()) {
+                   glClear(GL_COLOR_BUFFER_BIT);
+                   Render::renderBalls(game);
+                   game.m_drawList.flush();
+                   glFinish();
+                 }
+                 simulation.reset();
+               });
+
+  // Atualização e desenho de param partículas vivas, com transform feedback;
+  // a CPU só envia alguns uniforms por frame, qualquer que seja param
+  m_runner.add("Render/particles", {16384, 131072},
+               [](bench::State &state) {
+                 auto const count{static_cast<std::size_t>(state.param())};
+                 abcg::OpenGLParticleSystem particles;
+                 particles.create({.capacity = count});
+                 particles.emit({.lifetime = 1.0e6f, .count = count});
+                 state.setItemsPerIteration(static_cast<double>(count));
+                 while (state.next()) {
+                   glClear(GL_COLOR_BUFFER_BIT);
+                   particles.update(1.0f / 60.0f);
+                   particles.render();
+                   glFinish();
+                 }
+                 particles.destroy();
+               });
+
+  // Um frame completo do jogo, com param obstáculos. A camada estática é
+  // desenhada no primeiro frame, de modo que o tempo deve ser o mesmo
+  // qualquer que seja param
+  m_runner.add("Render/frame", {6, 128, 10000},
+               [&game, &simulation](bench::State &state) {
+                 simulation.generateObstacles(
+                     1, LayoutSettings{
+                            .count = static_cast<int>(state.param())});
+                 while (state.next()) {
+                   game.onPaint();
+                   glFinish();
+                 }
+               });
+}
+
+void runRenderBenchmarks(bench::Runner &runner, int argc, char **argv) {
+  abcg::Application app(argc, argv);
+
+  RenderBenchmark window{runner};
+  window.setWindowSettings({.width = 600,
+                            .height = 800,
+                            .showFPS = false,
+                            .showFullscreenButton = false,
+                            .title = "Pinball Benchmark",
+                            .hidden = true});
+
+  app.run(window);
+}
@@ -0,0 +1,108 @@
+#include "benchmark.hpp"
+#include "benchsuites.hpp"
+#include "sessionstore.hpp"
+
+#include <filesystem>
+#include <fmt/core.h>
+#include <map>
+#include <string>
+
+namespace {
+
+// Histórico de uma sessão por dia durante historyDays, por paciente
+constexpr int historyDays{3 * 365};
+
+// Arquivos de histórico gravados uma única vez por número de pacientes e
+// apagados no fim do programa
+class HistoryFiles {
+public:
+  HistoryFiles() = default;
+  HistoryFiles(HistoryFiles const &) = delete;
+  HistoryFiles &operator=(HistoryFiles const &) = delete;
+
+  ~HistoryFiles() {
+    std::error_code error;
+    for (auto const &[patients, path] : m_paths) {
+      std::filesystem::remove(path, error);
+    }
+  }
+
+  std::string const &get(int patients) {
+    if (auto const found{m_paths.find(patients)}; found != m_paths.end())
+      return found->second;
+
+    auto const path{(std::filesystem::temp_directory_path() /
+                     fmt::format("pinball_bench_{}.pbss", patients))
+                        .string()};
+    std::filesystem::remove(path);
+
+    // As sessões são gravadas dia a dia, alternando os pacientes, como no
+    // uso real: as páginas de cada paciente ficam espalhadas pelo arquivo
+    SessionStore store{path};
+    auto const start{SessionStore::now() - std::chrono::days{historyDays}};
+    for (int day = 0; day < historyDays; ++day) {
+      for (int patient = 0; patient < patients; ++patient) {
+        store.append(patientName(patient),
+                     {.startTime = start + std::chrono::days{day},
+                      .duration = std::chrono::minutes{10},
+                      .attempts = 40,
+                      .responses = 38,
+                      .meanLatency = std::chrono::microseconds{350'000},
+                      .medianLatency = std::chrono::microseconds{340'000},
+                      .minLatency = std::chrono::microseconds{220'000},
+                      .maxLatency = std::chrono::microseconds{700'000}});
+      }
+    }
+    return m_paths.emplace(patients, path).first->second;
+  }
+
+  static std::string patientName(int patient) {
+    return fmt::format("patient{:02}", patient);
+  }
+
+private:
+  std::map<int, std::string> m_paths;
+};
+
+HistoryFiles &historyFiles() {
+  static HistoryFiles files;
+  return files;
+}
+
+} // namespace
+
+void registerStoreBenchmarks(bench::Runner &runner) {
+  // Abertura (mapeamento e índice esparso) de um histórico de três anos com
+  // param pacientes, seguida da consulta dos últimos 90 dias de um deles,
+  // como a janela de progresso do jogo
+  runner.add("SessionStore/openAndQuery", {1, 20},
+             [](bench::State &state) {
+               auto const patients{static_cast<int>(state.param())};
+               auto const &path{historyFiles().get(patients)};
+               auto const patient{HistoryFiles::patientName(patients / 2)};
+               while (state.next()) {
+                 SessionStore const store{path};
+                 auto const to{SessionStore::now()};
+                 auto const records{
+                     store.query(patient, to - std::chrono::days{90}, to)};
+                 bench::doNotOptimize(records.size());
+               }
+             });
+
+  // Só a consulta, com o arquivo já aberto, de param dias de um paciente
+  // entre 20
+  runner.add("SessionStore/query", {7, 90, historyDays},
+             [](bench::State &state) {
+               SessionStore const store{historyFiles().get(20)};
+               auto const patient{HistoryFiles::patientName(10)};
+               auto const days{std::chrono::days{state.param()}};
+               std::size_t records{};
+               while (state.next()) {
+                 auto const to{SessionStore::now()};
+                 auto const result{store.query(patient, to - days, to)};
+                 records = result.size();
+                 bench::doNotOptimize(records);
+               }
+               state.setItemsPerIteration(static_cast<double>(records));
+             });
+}
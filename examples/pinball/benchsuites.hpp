@@ -0,0 +1,17 @@
+#ifndef BENCHSUITES_HPP_
+#define BENCHSUITES_HPP_
+
+#include "benchmark.hpp"
+
+// Benchmarks da física (benchphysics.cpp), sempre disponíveis
+void registerPhysicsBenchmarks(bench::Runner &runner);
+
+// Benchmarks do histórico de sessões (benchstore.cpp), com arquivos
+// temporários
+void registerStoreBenchmarks(bench::Runner &runner);
+
+// Benchmarks das funções Render::* (benchrender.cpp), executados em uma
+// janela SDL oculta; só existem nas compilações com OpenGL
+void runRenderBenchmarks(bench::Runner &runner, int argc, char **argv);
+
+#endif
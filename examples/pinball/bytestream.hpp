@@ -0,0 +1,105 @@
+#ifndef BYTESTREAM_HPP_
+#define BYTESTREAM_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Escrita e leitura dos formatos binários do jogo (SessionLog e telemetria),
+// em little-endian, independente da plataforma
+
+class ByteWriter {
+public:
+  explicit ByteWriter(std::vector<std::uint8_t> &data) : m_data{data} {}
+
+  void bytes(std::uint64_t value, int count) {
+    for (int i = 0; i < count; ++i) {
+      m_data.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+  }
+
+  // Inteiro sem sinal com 7 bits por byte; o bit mais alto indica que há
+  // mais bytes a seguir
+  void varint(std::uint64_t value) {
+    while (value >= 0x80) {
+      m_data.push_back(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    m_data.push_back(static_cast<std::uint8_t>(value));
+  }
+
+  // Inteiro com sinal em varint: os valores pequenos, positivos ou
+  // negativos, ocupam poucos bytes (0, -1, 1, -2... viram 0, 1, 2, 3...)
+  void zigzag(std::int64_t value) {
+    varint((static_cast<std::uint64_t>(value) << 1) ^
+           static_cast<std::uint64_t>(value >> 63));
+  }
+
+  void real(float value) { bytes(std::bit_cast<std::uint32_t>(value), 4); }
+
+private:
+  std::vector<std::uint8_t> &m_data;
+};
+
+class ByteReader {
+public:
+  // format nomeia o formato nas mensagens de erro
+  ByteReader(std::span<std::uint8_t const> data, std::string format)
+      : m_data{data}, m_format{std::move(format)} {}
+
+  std::uint64_t bytes(int count) {
+    if (m_position + static_cast<std::size_t>(count) > m_data.size())
+      throw std::runtime_error("Truncated " + m_format);
+    std::uint64_t value{};
+    for (int i = 0; i < count; ++i) {
+      value |= std::uint64_t{m_data[m_position++]} << (8 * i);
+    }
+    return value;
+  }
+
+  std::uint64_t varint() {
+    std::uint64_t value{};
+    for (int shift = 0; shift < 64; shift += 7) {
+      auto const byte{bytes(1)};
+      value |= (byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+        return value;
+    }
+    throw std::runtime_error("Invalid varint in " + m_format);
+  }
+
+  std::int64_t zigzag() {
+    auto const value{varint()};
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+  }
+
+  float real() {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(bytes(4)));
+  }
+
+  // Próximos count bytes, sem copiar
+  std::span<std::uint8_t const> span(std::size_t count) {
+    if (count > remaining())
+      throw std::runtime_error("Truncated " + m_format);
+    auto const result{m_data.subspan(m_position, count)};
+    m_position += count;
+    return result;
+  }
+
+  [[nodiscard]] std::size_t remaining() const noexcept {
+    return m_data.size() - m_position;
+  }
+
+private:
+  std::span<std::uint8_t const> m_data;
+  std::string m_format;
+  std::size_t m_position{};
+};
+
+#endif
@@ -0,0 +1,286 @@
+#include "collision.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+
+namespace {
+// Distância abaixo da qual o avanço conservativo considera haver contato
+constexpr float contactTolerance{1.0e-4f};
+constexpr int maxAdvancementIterations{32};
+
+// Se a direção offset (a partir do centro) está dentro do intervalo angular
+// [startAngle, endAngle]
+bool isWithinArc(glm::vec2 offset, float startAngle, float endAngle) {
+  auto const twoPi{2.0f * static_cast<float>(M_PI)};
+  auto angle{std::atan2(offset.y, offset.x) - startAngle};
+  angle -= twoPi * std::floor(angle / twoPi);
+  return angle <= endAngle - startAngle;
+}
+
+glm::vec2 pointOnCircle(glm::vec2 center, float radius, float angle) {
+  return center + radius * glm::vec2{std::cos(angle), std::sin(angle)};
+}
+} // namespace
+
+std::optional<float> Collision::sweepCircleCircle(glm::vec2 position,
+                                                  glm::vec2 velocity,
+                                                  float radius,
+                                                  glm::vec2 center,
+                                                  float otherRadius,
+                                                  float maxTime) {
+  // Resolve |p + v t|^2 = R^2 para a posição relativa ao centro
+  auto const relPos{position - center};
+  auto const sumRadii{radius + otherRadius};
+  auto const c{glm::dot(relPos, relPos) - sumRadii * sumRadii};
+  auto const b{glm::dot(relPos, velocity)};
+
+  // Sobrepostos: só há contato se a bola ainda estiver se aproximando
+  if (c <= 0.0f)
+    return b < 0.0f ? std::optional{0.0f} : std::nullopt;
+
+  // Afastando-se, ou a trajetória não cruza o círculo expandido
+  if (b >= 0.0f)
+    return std::nullopt;
+  auto const a{glm::dot(velocity, velocity)};
+  auto const discriminant{b * b - a * c};
+  if (discriminant < 0.0f)
+    return std::nullopt;
+
+  auto const time{(-b - std::sqrt(discriminant)) / a};
+  if (time > maxTime)
+    return std::nullopt;
+  return std::max(time, 0.0f);
+}
+
+std::optional<float> Collision::sweepCircleSegment(glm::vec2 position,
+                                                   glm::vec2 velocity,
+                                                   float radius, glm::vec2 a,
+                                                   glm::vec2 b,
+                                                   float maxTime) {
+  auto const edge{b - a};
+  auto const edgeLength{glm::length(edge)};
+  if (edgeLength <= 0.0f)
+    return sweepCircleCircle(position, velocity, radius, a, 0.0f, maxTime);
+
+  auto const direction{edge / edgeLength};
+
+  // Normal apontando para o lado em que a bola está
+  glm::vec2 normal{-direction.y, direction.x};
+  auto distance{glm::dot(position - a, normal)};
+  if (distance < 0.0f) {
+    normal = -normal;
+    distance = -distance;
+  }
+
+  std::optional<float> result;
+
+  // Contato com o interior do segmento
+  auto const normalSpeed{glm::dot(velocity, normal)};
+  if (distance <= radius) {
+    auto const s{glm::dot(position - a, direction)};
+    if (s >= 0.0f && s <= edgeLength)
+      return normalSpeed < 0.0f ? std::optional{0.0f} : std::nullopt;
+  } else if (normalSpeed < 0.0f) {
+    auto const time{(distance - radius) / -normalSpeed};
+    if (time <= maxTime) {
+      auto const s{glm::dot(position + velocity * time - a, direction)};
+      if (s >= 0.0f && s <= edgeLength)
+        result = time;
+    }
+  }
+
+  // Contato com as extremidades
+  for (auto const &endpoint : {a, b}) {
+    if (auto const time{sweepCircleCircle(position, velocity, radius,
+                                          endpoint, 0.0f, maxTime)};
+        time && (!result || *time < *result)) {
+      result = time;
+    }
+  }
+
+  return result;
+}
+
+std::optional<float> Collision::sweepCircleArc(
+    glm::vec2 position, glm::vec2 velocity, float radius, glm::vec2 center,
+    float arcRadius, float startAngle, float endAngle, float maxTime) {
+  std::optional<float> result;
+  auto const consider = [&](std::optional<float> time) {
+    if (time && (!result || *time < *result))
+      result = time;
+  };
+
+  auto const relPos{position - center};
+  auto const a{glm::dot(velocity, velocity)};
+  auto const b{glm::dot(relPos, velocity)};
+  auto const distanceSquared{glm::dot(relPos, relPos)};
+
+  // Bola fora da circunferência: contato com o lado externo, como em
+  // sweepCircleCircle
+  if (distanceSquared >= arcRadius * arcRadius) {
+    if (auto const time{sweepCircleCircle(position, velocity, radius, center,
+                                          arcRadius, maxTime)};
+        time && isWithinArc(relPos + velocity * *time, startAngle, endAngle))
+      consider(time);
+  }
+  // Bola dentro: contato com o lado interno quando a distância ao centro
+  // chega a arcRadius - radius, saindo do círculo
+  else if (auto const innerRadius{arcRadius - radius}; innerRadius > 0.0f) {
+    auto const c{distanceSquared - innerRadius * innerRadius};
+    std::optional<float> time;
+    if (c >= 0.0f) {
+      if (b > 0.0f)
+        time = 0.0f;
+    } else if (a > 0.0f) {
+      auto const exitTime{(-b + std::sqrt(b * b - a * c)) / a};
+      if (exitTime <= maxTime)
+        time = exitTime;
+    }
+    if (time && isWithinArc(relPos + velocity * *time, startAngle, endAngle))
+      consider(time);
+  }
+
+  // Contato com as extremidades
+  for (auto const angle : {startAngle, endAngle}) {
+    consider(sweepCircleCircle(position, velocity, radius,
+                               pointOnCircle(center, arcRadius, angle), 0.0f,
+                               maxTime));
+  }
+
+  return result;
+}
+
+std::optional<float>
+Collision::sweepCircleRotatingCapsule(glm::vec2 position, glm::vec2 velocity,
+                                      float radius,
+                                      RotatingCapsule const &capsule,
+                                      float maxTime) {
+  auto const sumRadii{radius + capsule.radius};
+
+  // Limite superior da velocidade de aproximação entre a bola e qualquer
+  // ponto da cápsula, usado pelo avanço conservativo
+  auto const maxApproachSpeed{glm::length(velocity) +
+                              std::abs(capsule.angularVelocity) *
+                                  capsule.length};
+  if (maxApproachSpeed <= 0.0f) {
+    return sweepCircleSegment(position, velocity, sumRadii, capsule.pivot,
+                              capsuleTip(capsule, 0.0f), maxTime);
+  }
+
+  auto time{0.0f};
+  for (int iteration = 0; iteration < maxAdvancementIterations; ++iteration) {
+    auto const ballPosition{position + velocity * time};
+    auto const closest{closestPointOnCapsule(capsule, ballPosition, time)};
+    auto const offset{ballPosition - closest};
+    auto const gap{glm::length(offset) - sumRadii};
+
+    if (gap <= contactTolerance) {
+      if (time > 0.0f)
+        return time;
+
+      // Já em contato: ignora se a bola estiver se afastando da superfície
+      auto const surfaceVelocity{capsuleSurfaceVelocity(capsule, closest)};
+      auto const normalSpeed{glm::dot(velocity - surfaceVelocity, offset)};
+      return normalSpeed < 0.0f ? std::optional{0.0f} : std::nullopt;
+    }
+
+    // Nenhum ponto pode se aproximar mais que gap neste intervalo de tempo
+    time += gap / maxApproachSpeed;
+    if (time > maxTime)
+      return std::nullopt;
+  }
+
+  // Convergência lenta, em geral uma passagem rasante: só é contato se a
+  // distância no último instante já estiver dentro da tolerância. Um contato
+  // real perdido aqui ainda é separado pela correção das sobreposições
+  auto const ballPosition{position + velocity * time};
+  auto const closest{closestPointOnCapsule(capsule, ballPosition, time)};
+  auto const gap{glm::length(ballPosition - closest) - sumRadii};
+  return gap <= contactTolerance ? std::optional{time} : std::nullopt;
+}
+
+glm::vec2 Collision::closestPointOnSegment(glm::vec2 point, glm::vec2 a,
+                                           glm::vec2 b) {
+  auto const edge{b - a};
+  auto const lengthSquared{glm::dot(edge, edge)};
+  if (lengthSquared <= 0.0f)
+    return a;
+  auto const s{std::clamp(glm::dot(point - a, edge) / lengthSquared, 0.0f,
+                          1.0f)};
+  return a + edge * s;
+}
+
+glm::vec2 Collision::closestPointOnArc(glm::vec2 point, glm::vec2 center,
+                                       float arcRadius, float startAngle,
+                                       float endAngle) {
+  auto const offset{point - center};
+  auto const distance{glm::length(offset)};
+  if (distance > 0.0f && isWithinArc(offset, startAngle, endAngle))
+    return center + offset * (arcRadius / distance);
+
+  // Fora do intervalo angular: a extremidade mais próxima
+  auto const start{pointOnCircle(center, arcRadius, startAngle)};
+  auto const end{pointOnCircle(center, arcRadius, endAngle)};
+  auto const startOffset{point - start};
+  auto const endOffset{point - end};
+  return glm::dot(startOffset, startOffset) <= glm::dot(endOffset, endOffset)
+             ? start
+             : end;
+}
+
+bool Collision::isNearCircle(glm::vec2 point, glm::vec2 center,
+                             float circleRadius, float distance) {
+  auto const offset{point - center};
+  auto const distanceSquared{glm::dot(offset, offset)};
+  auto const outer{circleRadius + distance};
+  auto const inner{circleRadius - distance};
+  return distanceSquared < outer * outer &&
+         (inner <= 0.0f || distanceSquared > inner * inner);
+}
+
+// Extremidade livre da cápsula no instante dado
+glm::vec2 Collision::capsuleTip(RotatingCapsule const &capsule, float time) {
+  auto const angle{capsule.angle + capsule.angularVelocity * time};
+  return capsule.pivot +
+         capsule.length * glm::vec2{std::cos(angle), std::sin(angle)};
+}
+
+glm::vec2 Collision::closestPointOnCapsule(RotatingCapsule const &capsule,
+                                           glm::vec2 point, float time) {
+  return closestPointOnSegment(point, capsule.pivot,
+                               capsuleTip(capsule, time));
+}
+
+// Rotação em torno do pivô: v = omega x r
+glm::vec2 Collision::capsuleSurfaceVelocity(RotatingCapsule const &capsule,
+                                            glm::vec2 point) {
+  auto const arm{point - capsule.pivot};
+  return capsule.angularVelocity * glm::vec2{-arm.y, arm.x};
+}
+
+glm::vec2 Collision::resolveVelocity(glm::vec2 velocity, glm::vec2 normal,
+                                     glm::vec2 surfaceVelocity,
+                                     float restitution, float friction) {
+  auto const relativeVelocity{velocity - surfaceVelocity};
+  auto const normalSpeed{glm::dot(relativeVelocity, normal)};
+  if (normalSpeed >= 0.0f)
+    return velocity;
+
+  auto result{relativeVelocity -
+              (1.0f + restitution) * normalSpeed * normal + surfaceVelocity};
+
+  // O atrito não inverte o sentido do deslizamento: no máximo, zera a
+  // velocidade tangencial relativa
+  if (friction > 0.0f) {
+    auto const tangent{relativeVelocity - normalSpeed * normal};
+    auto const tangentSpeed{glm::length(tangent)};
+    if (tangentSpeed > 0.0f) {
+      auto const normalImpulse{-(1.0f + restitution) * normalSpeed};
+      result -= tangent *
+                (std::min(tangentSpeed, friction * normalImpulse) /
+                 tangentSpeed);
+    }
+  }
+  return result;
+}
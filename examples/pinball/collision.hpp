@@ -0,0 +1,71 @@
+#ifndef COLLISION_HPP_
+#define COLLISION_HPP_
+
+#include <glm/vec2.hpp>
+#include <optional>
+
+// Segmento com raio (cápsula) que gira em torno de um pivô fixo, como um
+// flipper. O ângulo varia linearmente durante o passo:
+//   angle(t) = angle + angularVelocity * t
+struct RotatingCapsule {
+  glm::vec2 pivot{};
+  float length{};
+  float radius{};
+  float angle{};
+  float angularVelocity{};
+};
+
+// Testes de colisão contínua (swept): cada função retorna o instante, dentro
+// de [0, maxTime], do primeiro contato de um círculo que se move com
+// velocidade constante, ou std::nullopt se não houver contato. Se os objetos
+// já estiverem sobrepostos e se aproximando, o contato ocorre em t = 0.
+class Collision {
+public:
+  static std::optional<float> sweepCircleCircle(glm::vec2 position,
+                                                glm::vec2 velocity,
+                                                float radius, glm::vec2 center,
+                                                float otherRadius,
+                                                float maxTime);
+  static std::optional<float> sweepCircleSegment(glm::vec2 position,
+                                                 glm::vec2 velocity,
+                                                 float radius, glm::vec2 a,
+                                                 glm::vec2 b, float maxTime);
+  // Arco de raio arcRadius em torno de center, de startAngle a endAngle no
+  // sentido anti-horário; a bola pode atingi-lo por dentro ou por fora
+  static std::optional<float>
+  sweepCircleArc(glm::vec2 position, glm::vec2 velocity, float radius,
+                 glm::vec2 center, float arcRadius, float startAngle,
+                 float endAngle, float maxTime);
+  static std::optional<float>
+  sweepCircleRotatingCapsule(glm::vec2 position, glm::vec2 velocity,
+                             float radius, RotatingCapsule const &capsule,
+                             float maxTime);
+
+  static glm::vec2 closestPointOnSegment(glm::vec2 point, glm::vec2 a,
+                                         glm::vec2 b);
+  static glm::vec2 closestPointOnArc(glm::vec2 point, glm::vec2 center,
+                                     float arcRadius, float startAngle,
+                                     float endAngle);
+  // Teste barato antes de closestPointOnArc: falso se todo o círculo do arco
+  // está a mais de distance do ponto
+  static bool isNearCircle(glm::vec2 point, glm::vec2 center,
+                           float circleRadius, float distance);
+  static glm::vec2 capsuleTip(RotatingCapsule const &capsule, float time);
+  // Ponto da cápsula mais próximo de point no instante dado e velocidade da
+  // superfície nesse ponto
+  static glm::vec2 closestPointOnCapsule(RotatingCapsule const &capsule,
+                                         glm::vec2 point, float time);
+  static glm::vec2 capsuleSurfaceVelocity(RotatingCapsule const &capsule,
+                                          glm::vec2 point);
+
+  // Velocidade de um círculo após o contato com uma superfície de massa
+  // infinita que se move com surfaceVelocity. A componente normal da
+  // velocidade relativa é refletida com a restituição dada, e o atrito de
+  // Coulomb reduz a componente tangencial em até friction vezes o impulso
+  // normal. Se o círculo já estiver se afastando, a velocidade não muda.
+  static glm::vec2 resolveVelocity(glm::vec2 velocity, glm::vec2 normal,
+                                   glm::vec2 surfaceVelocity,
+                                   float restitution, float friction);
+};
+
+#endif
@@ -0,0 +1,208 @@
+#include "drawlist.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+namespace {
+// Campos da chave de ordenação, do mais para o menos significativo. Os nomes
+// de programas e VAOs são truncados em 16 bits; uma colisão só mudaria o
+// agrupamento, já que o comando guarda os nomes completos
+constexpr int groupShift{56};
+constexpr int blendShift{55};
+constexpr int programShift{39};
+constexpr int vaoShift{23};
+constexpr int modeShift{19};
+constexpr std::uint64_t nameMask{0xFFFF};
+constexpr std::uint64_t modeMask{0xF};
+constexpr std::uint64_t sequenceMask{(std::uint64_t{1} << modeShift) - 1};
+
+constexpr std::uint32_t noObject{std::numeric_limits<std::uint32_t>::max()};
+
+GLsizeiptr alignUp(GLsizeiptr size, GLsizeiptr alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Aponta os atributos por instância (divisor 1) do VAO para as instâncias que
+// começam em offset no buffer. O OpenGL ES 3.0 não tem o parâmetro de
+// primeira instância das chamadas de desenho, e por isso o deslocamento vai
+// nos ponteiros dos atributos
+void bindInstances(GLuint buffer, GLintptr offset) {
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+  auto const instanceAttribute = [offset](GLuint location, GLint size,
+                                          std::size_t member) {
+    glVertexAttribPointer(
+        location, size, GL_FLOAT, GL_FALSE, sizeof(CircleInstance),
+        reinterpret_cast<void const *>(static_cast<std::size_t>(offset) +
+                                       member));
+    glVertexAttribDivisor(location, 1);
+    glEnableVertexAttribArray(location);
+  };
+  instanceAttribute(1, 2, offsetof(CircleInstance, position));
+  instanceAttribute(2, 1, offsetof(CircleInstance, radius));
+  instanceAttribute(3, 4, offsetof(CircleInstance, color));
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+} // namespace
+
+void DrawList::create() {
+  m_uniformStream.create({.target = GL_UNIFORM_BUFFER});
+  m_instanceStream.create({.target = GL_ARRAY_BUFFER});
+}
+
+void DrawList::destroy() {
+  m_uniformStream.destroy();
+  m_instanceStream.destroy();
+  m_commands.clear();
+  m_objects.clear();
+  m_instances.clear();
+}
+
+std::uint32_t DrawList::addObject(ObjectUniforms const &uniforms) {
+  m_objects.push_back(uniforms);
+  return static_cast<std::uint32_t>(m_objects.size() - 1);
+}
+
+void DrawList::draw(std::uint8_t group, GLuint program, Mesh const &mesh,
+                    GLenum mode, GLint first, GLsizei count,
+                    std::uint32_t object) {
+  m_commands.push_back({.key = makeKey(group, false, program, mesh.VAO, mode),
+                        .program = program,
+                        .VAO = mesh.VAO,
+                        .mode = mode,
+                        .first = first,
+                        .count = count,
+                        .object = object});
+}
+
+void DrawList::drawCircles(std::uint8_t group, GLuint program,
+                           Mesh const &mesh,
+                           std::span<CircleInstance const> instances) {
+  if (instances.empty())
+    return;
+
+  auto const firstInstance{static_cast<std::uint32_t>(m_instances.size())};
+  m_instances.insert(m_instances.end(), instances.begin(), instances.end());
+  m_commands.push_back(
+      {.key = makeKey(group, true, program, mesh.VAO, GL_TRIANGLE_STRIP),
+       .program = program,
+       .VAO = mesh.VAO,
+       .mode = GL_TRIANGLE_STRIP,
+       .count = mesh.vertexCount,
+       .object = noObject,
+       .firstInstance = firstInstance,
+       .instanceCount = static_cast<GLsizei>(instances.size()),
+       .blend = true});
+}
+
+// Chave com o grupo nos bits mais significativos, seguido do estado do
+// comando; a ordem de inserção, nos bits menos significativos, só desempata
+// comandos com o mesmo estado
+std::uint64_t DrawList::makeKey(std::uint8_t group, bool blend,
+                                GLuint program, GLuint VAO,
+                                GLenum mode) const {
+  return (std::uint64_t{group} << groupShift) |
+         (std::uint64_t{blend} << blendShift) |
+         ((program & nameMask) << programShift) |
+         ((VAO & nameMask) << vaoShift) | ((mode & modeMask) << modeShift) |
+         (m_commands.size() & sequenceMask);
+}
+
+void DrawList::flush() {
+  std::sort(m_commands.begin(), m_commands.end(),
+            [](DrawCommand const &lhs, DrawCommand const &rhs) {
+              return lhs.key < rhs.key;
+            });
+
+  // Uniforms de todos os objetos em uma única alocação, cada um no início de
+  // um bloco com o alinhamento exigido por glBindBufferRange
+  auto const objectStride{alignUp(GLsizeiptr{sizeof(ObjectUniforms)},
+                                  m_uniformStream.getAlignment())};
+  GLintptr objectsOffset{};
+  if (!m_objects.empty()) {
+    auto const allocation{m_uniformStream.allocate(
+        objectStride * static_cast<GLsizeiptr>(m_objects.size()))};
+    auto *const bytes{static_cast<std::byte *>(allocation.pointer)};
+    for (std::size_t i = 0; i < m_objects.size(); ++i) {
+      std::memcpy(bytes + i * static_cast<std::size_t>(objectStride),
+                  &m_objects[i], sizeof(ObjectUniforms));
+    }
+    m_uniformStream.commit(allocation);
+    objectsOffset = allocation.offset;
+  }
+
+  // Atributos de todas as instâncias, também em uma única alocação
+  GLintptr instancesOffset{};
+  if (!m_instances.empty()) {
+    auto const bytes{static_cast<GLsizeiptr>(m_instances.size() *
+                                             sizeof(CircleInstance))};
+    auto const allocation{m_instanceStream.allocate(bytes)};
+    std::memcpy(allocation.pointer, m_instances.data(),
+                static_cast<std::size_t>(bytes));
+    m_instanceStream.commit(allocation);
+    instancesOffset = allocation.offset;
+  }
+
+  // Estado atual; cada troca só é feita quando o comando precisa de outro
+  // valor. Os ponteiros de instância são estado do VAO e valem só para esta
+  // alocação, então começam indefinidos
+  GLuint program{};
+  GLuint VAO{};
+  bool blend{};
+  auto object{noObject};
+  GLuint instancesVAO{};
+  auto firstInstance{noObject};
+
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  for (auto const &command : m_commands) {
+    if (command.program != program) {
+      program = command.program;
+      glUseProgram(program);
+    }
+    if (command.VAO != VAO) {
+      VAO = command.VAO;
+      glBindVertexArray(VAO);
+    }
+    if (command.blend != blend) {
+      blend = command.blend;
+      if (blend)
+        glEnable(GL_BLEND);
+      else
+        glDisable(GL_BLEND);
+    }
+
+    if (command.instanceCount > 0) {
+      if (command.VAO != instancesVAO ||
+          command.firstInstance != firstInstance) {
+        instancesVAO = command.VAO;
+        firstInstance = command.firstInstance;
+        bindInstances(m_instanceStream.getBuffer(),
+                      instancesOffset +
+                          static_cast<GLintptr>(firstInstance *
+                                                sizeof(CircleInstance)));
+      }
+      glDrawArraysInstanced(command.mode, command.first, command.count,
+                            command.instanceCount);
+      continue;
+    }
+
+    if (command.object != object) {
+      object = command.object;
+      glBindBufferRange(GL_UNIFORM_BUFFER, objectBinding,
+                        m_uniformStream.getBuffer(),
+                        objectsOffset + object * objectStride,
+                        sizeof(ObjectUniforms));
+    }
+    glDrawArrays(command.mode, command.first, command.count);
+  }
+  if (blend)
+    glDisable(GL_BLEND);
+
+  // As regiões podem ser reaproveitadas quando a GPU terminar estes desenhos
+  m_uniformStream.fence();
+  m_instanceStream.fence();
+
+  m_commands.clear();
+  m_objects.clear();
+  m_instances.clear();
+}
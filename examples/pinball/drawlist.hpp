@@ -0,0 +1,103 @@
+#ifndef DRAWLIST_HPP_
+#define DRAWLIST_HPP_
+
+#include "abcgOpenGL.hpp"
+#include "mesh.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+// Atributos de cada instância do círculo: centro e raio em coordenadas do
+// mundo e cor
+struct CircleInstance {
+  glm::vec2 position{};
+  float radius{};
+  glm::vec4 color{};
+};
+
+// Dados de um objeto no bloco de uniforms Object (layout std140) do programa
+// de cor sólida. Os membros seguem as regras de alinhamento do std140: vec4
+// no byte 0, vec2 no 16 e os dois floats no 24 e no 28
+struct ObjectUniforms {
+  glm::vec4 color{1.0f};
+  glm::vec2 translate{};
+  float scale{1.0f};
+  float rotate{};
+};
+static_assert(sizeof(ObjectUniforms) == 32);
+
+// Chamada de desenho gravada na DrawList. É um POD pequeno, de modo que
+// ordenar os comandos é barato
+struct DrawCommand {
+  // Chave de ordenação: grupo, mistura, programa, VAO, primitiva e ordem de
+  // inserção (veja DrawList::makeKey)
+  std::uint64_t key{};
+  GLuint program{};
+  GLuint VAO{};
+  GLenum mode{};
+  GLint first{};
+  GLsizei count{};
+  // Objeto em DrawList, nas chamadas do programa de cor sólida
+  std::uint32_t object{};
+  // Instâncias em DrawList, nas chamadas instanciadas (círculos)
+  std::uint32_t firstInstance{};
+  GLsizei instanceCount{};
+  bool blend{};
+};
+
+// Lista das chamadas de desenho de um frame. As rotinas de Render apenas
+// acrescentam comandos; DrawList::flush ordena os comandos pelo estado que
+// eles usam e os executa, trocando programa, VAO, mistura e uniforms só
+// quando o próximo comando precisa de outro valor.
+//
+// Os uniforms de todos os objetos vão para a GPU em um único bloco do buffer
+// de uniforms, e os atributos de todas as instâncias, em um único bloco do
+// buffer de instâncias (ambos abcg::OpenGLStreamBuffer). Cada comando só
+// escolhe a parte do bloco que lhe cabe, com glBindBufferRange ou com os
+// ponteiros dos atributos.
+//
+// A gravação não faz chamadas OpenGL, de modo que listas podem ser montadas
+// em outras threads e executadas na thread do contexto.
+class DrawList {
+public:
+  // Ponto de ligação do bloco Object (glUniformBlockBinding)
+  static constexpr GLuint objectBinding{0};
+
+  void create();
+  void destroy();
+
+  // Guarda os uniforms de um objeto, que podem ser usados por várias
+  // chamadas, e devolve seu índice
+  std::uint32_t addObject(ObjectUniforms const &uniforms);
+
+  // Os grupos (group) são desenhados em ordem crescente; dentro de um grupo,
+  // a ordem segue o estado, e não a ordem de inserção. Comandos que se
+  // sobrepõem e dependem da ordem devem ficar em grupos diferentes
+  void draw(std::uint8_t group, GLuint program, Mesh const &mesh, GLenum mode,
+            GLint first, GLsizei count, std::uint32_t object);
+  // Círculos instanciados, com a malha do quadrado unitário e mistura
+  // ativada para a borda suavizada. As instâncias são copiadas
+  void drawCircles(std::uint8_t group, GLuint program, Mesh const &mesh,
+                   std::span<CircleInstance const> instances);
+
+  // Executa e descarta os comandos gravados
+  void flush();
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_commands.size(); }
+
+private:
+  std::vector<DrawCommand> m_commands;
+  std::vector<ObjectUniforms> m_objects;
+  std::vector<CircleInstance> m_instances;
+
+  abcg::OpenGLStreamBuffer m_uniformStream;
+  abcg::OpenGLStreamBuffer m_instanceStream;
+
+  [[nodiscard]] std::uint64_t makeKey(std::uint8_t group, bool blend,
+                                      GLuint program, GLuint VAO,
+                                      GLenum mode) const;
+};
+
+#endif
@@ -0,0 +1,191 @@
+// pinball_eval: avalia layouts de obstáculos por simulação de Monte Carlo.
+//
+// Gera layouts candidatos e joga muitas bolas em cada um, distribuindo os
+// lotes de bolas entre todos os núcleos. Uso:
+//
+//   pinball_eval [--layouts N] [--seed N] [--balls N] [--obstacles N]
+//                [--policy none|random|reactive] [--reaction-ms MS]
+//                [--hold-ms MS] [--max-seconds S] [--threads N]
+//                [--heatmaps DIRETORIO] [--table MESA]
+//
+// Para cada layout são mostrados a taxa de queda (bolas que caíram antes de
+// --max-seconds), o tempo de vida médio da bola, as quedas e os toques nos
+// flippers por minuto de jogo. Com --heatmaps, os mapas de ocupação e de
+// colisões de cada layout são gravados em CSV.
+
+#include "montecarlo.hpp"
+#include "simulation.hpp"
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <fmt/core.h>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct Options {
+  int layouts{8};
+  std::uint32_t layoutSeed{1};
+  LayoutSettings layout;
+  EvaluationSettings evaluation;
+  unsigned threads{0};
+  std::string heatmapDirectory;
+  std::string table;
+};
+
+template <typename T> T parseNumber(std::string_view text) {
+  T value{};
+  auto const *last{text.data() + text.size()};
+  auto const [ptr, ec]{std::from_chars(text.data(), last, value)};
+  if (ec != std::errc{} || ptr != last)
+    throw std::runtime_error(fmt::format("Invalid number: {}", text));
+  return value;
+}
+
+FlipperPolicy parsePolicy(std::string_view text) {
+  if (text == "none")
+    return FlipperPolicy::None;
+  if (text == "random")
+    return FlipperPolicy::Random;
+  if (text == "reactive")
+    return FlipperPolicy::Reactive;
+  throw std::runtime_error(fmt::format("Unknown policy: {}", text));
+}
+
+Options parseOptions(std::span<char *> args) {
+  Options options;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    std::string_view const arg{args[i]};
+    auto value = [&]() -> std::string_view {
+      if (i + 1 >= args.size())
+        throw std::runtime_error(fmt::format("Missing value for {}", arg));
+      return args[++i];
+    };
+
+    auto &evaluation{options.evaluation};
+    if (arg == "--layouts")
+      options.layouts = parseNumber<int>(value());
+    else if (arg == "--seed")
+      options.layoutSeed = parseNumber<std::uint32_t>(value());
+    else if (arg == "--balls")
+      evaluation.ballsPerLayout = parseNumber<int>(value());
+    else if (arg == "--obstacles")
+      options.layout.count = parseNumber<int>(value());
+    else if (arg == "--policy")
+      evaluation.policy = parsePolicy(value());
+    else if (arg == "--reaction-ms")
+      evaluation.reactionTime = parseNumber<double>(value()) / 1000.0;
+    else if (arg == "--hold-ms")
+      evaluation.holdTime = parseNumber<double>(value()) / 1000.0;
+    else if (arg == "--max-seconds")
+      evaluation.maxBallSeconds = parseNumber<double>(value());
+    else if (arg == "--threads")
+      options.threads = parseNumber<unsigned>(value());
+    else if (arg == "--heatmaps")
+      options.heatmapDirectory = value();
+    else if (arg == "--table")
+      options.table = value();
+    else
+      throw std::runtime_error(fmt::format("Unknown option: {}", arg));
+  }
+  return options;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    auto const options{
+        parseOptions(std::span{argv, static_cast<std::size_t>(argc)})};
+    auto const &evaluation{options.evaluation};
+    auto const layoutCount{
+        static_cast<std::size_t>(std::max(options.layouts, 0))};
+    auto const ballCount{
+        static_cast<std::uint64_t>(std::max(evaluation.ballsPerLayout, 0))};
+
+    auto const table{options.table.empty() ? Table::builtin()
+                                           : Table::load(options.table)};
+
+    // Um protótipo por layout; cada lote copia o seu
+    std::vector<Simulation> layouts(layoutCount);
+    std::vector<std::uint32_t> seeds(layoutCount);
+    for (std::size_t i = 0; i < layoutCount; ++i) {
+      seeds[i] = options.layoutSeed + static_cast<std::uint32_t>(i);
+      layouts[i].setTable(table);
+      layouts[i].generateObstacles(seeds[i], options.layout);
+    }
+
+    // Lotes pequenos o bastante para balancear a carga entre as threads
+    constexpr std::uint64_t batchSize{64};
+    auto const batchesPerLayout{(ballCount + batchSize - 1) / batchSize};
+    std::vector<LayoutStats> batches(layoutCount * batchesPerLayout);
+
+    auto const start{std::chrono::steady_clock::now()};
+    {
+      ThreadPool pool{options.threads};
+      fmt::print(stderr, "Simulating {} balls x {} layouts on {} threads\n",
+                 ballCount, layoutCount, pool.size());
+
+      for (std::size_t layout = 0; layout < layoutCount; ++layout) {
+        for (std::uint64_t batch = 0; batch < batchesPerLayout; ++batch) {
+          auto const first{batch * batchSize};
+          auto const count{std::min(batchSize, ballCount - first)};
+          auto &result{batches[layout * batchesPerLayout + batch]};
+          pool.submit([&, layout, first, count] {
+            result = simulateBalls(layouts[layout], evaluation, seeds[layout],
+                                   first, count);
+          });
+        }
+      }
+      pool.wait();
+    }
+    std::chrono::duration<double> const wallTime{
+        std::chrono::steady_clock::now() - start};
+
+    fmt::print("{:>6} {:>10} {:>8} {:>10} {:>11} {:>12} {:>12}\n", "layout",
+               "seed", "drain%", "lifetime", "drains/min", "flipper/min",
+               "obstacle/ball");
+
+    std::uint64_t totalTicks{};
+    for (std::size_t layout = 0; layout < layoutCount; ++layout) {
+      LayoutStats stats;
+      for (std::uint64_t batch = 0; batch < batchesPerLayout; ++batch) {
+        stats.merge(batches[layout * batchesPerLayout + batch]);
+      }
+      totalTicks += stats.lifetimeTicks;
+
+      auto const tickRate{layouts[layout].getTimestep().getTickRate()};
+      auto const obstaclesPerBall{
+          stats.balls > 0 ? static_cast<double>(stats.obstacleHits) /
+                                static_cast<double>(stats.balls)
+                          : 0.0};
+      fmt::print("{:>6} {:>10} {:>7.1f}% {:>9.2f}s {:>11.2f} {:>12.1f} "
+                 "{:>12.2f}\n",
+                 layout, seeds[layout], stats.drainRate() * 100.0,
+                 stats.meanLifetime(tickRate), stats.drainsPerMinute(tickRate),
+                 stats.flipperContactsPerMinute(tickRate), obstaclesPerBall);
+
+      if (!options.heatmapDirectory.empty()) {
+        auto const prefix{
+            fmt::format("{}/layout{}", options.heatmapDirectory, layout)};
+        stats.occupancy.saveCSV(prefix + "_occupancy.csv");
+        stats.hits.saveCSV(prefix + "_hits.csv");
+      }
+    }
+
+    fmt::print(stderr, "{:.1f} s, {:.0f} balls/s, {:.2e} steps/s\n",
+               wallTime.count(),
+               static_cast<double>(ballCount * layoutCount) / wallTime.count(),
+               static_cast<double>(totalTicks) / wallTime.count());
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
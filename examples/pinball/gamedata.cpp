@@ -1,5 +0,0 @@
-#include "gamedata.hpp"
-
-Flipper m_leftFlipper;
-Flipper m_rightFlipper;
-std::vector<Obstacle> m_obstacles;
@@ -2,28 +2,47 @@
 #define GAMEDATA_HPP_
 
 #include <glm/vec2.hpp>
-#include <vector>
 
 constexpr float WALL_LEFT = -1.0f;
 constexpr float WALL_RIGHT = 1.0f;
 constexpr float WALL_BOTTOM = -1.0f;
 constexpr float WALL_TOP = 1.0f;
 
+// Escala aplicada aos raios da bola e dos obstáculos ao desenhar e nos testes
+// de colisão
+constexpr float GAME_SCALE = 0.15f;
+
+struct Ball {
+  glm::vec2 position{};
+  glm::vec2 velocity{};
+  float radius{};
+  // Posição no início do último passo, usada para interpolar a renderização
+  glm::vec2 previousPosition{};
+};
+
 struct Flipper {
   glm::vec2 position{};
   float currentAngle{};
+  float previousAngle{};
   float targetAngle{};
   float angularVelocity{};
   float length{};
+  // Raio da cápsula usada nas colisões e no desenho
+  float radius{};
+  // Ângulos com o botão solto e pressionado
+  float restAngle{};
+  float activeAngle{};
+  // Restituição e coeficiente de atrito do contato com a bola
+  float restitution{};
+  float friction{};
 };
 
 struct Obstacle {
   glm::vec2 position;
   float radius;
-};
 
-extern Flipper m_leftFlipper;
-extern Flipper m_rightFlipper;
-extern std::vector<Obstacle> m_obstacles;
+  // Raio usado nos testes de colisão com a bola
+  [[nodiscard]] float collisionRadius() const { return radius / 2.5f; }
+};
 
 #endif
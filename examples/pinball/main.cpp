@@ -1,15 +1,97 @@
 #include "window.hpp"
 
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace {
+
+struct Options {
+  SessionSettings session;
+  // Amostras de MSAA. Os círculos já têm bordas suavizadas pelo shader, de
+  // modo que o MSAA só melhora as bordas dos flippers e das paredes
+  int samples{0};
+  bool threadedSimulation{false};
+  std::optional<double> tickRate;
+  // Amostragem da entrada entre os frames, em Hz (0: uma vez por frame)
+  int inputRate{0};
+};
+
+// Opções de linha de comando:
+//   --record ARQUIVO  grava a sessão (semente, layout e entradas) ao sair
+//   --replay ARQUIVO  reproduz uma sessão gravada em tempo real
+//   --patient ID      mostra o histórico do paciente, acrescenta a sessão
+//                     a ele ao sair e identifica o paciente na telemetria
+//   --store ARQUIVO   histórico de sessões usado com --patient (padrão:
+//                     pinball.pbss)
+//   --telemetry ARQUIVO
+//                     grava o estado desenhado em cada frame e as entradas,
+//                     em segundo plano, para análise posterior
+//   --samples N       usa MSAA com N amostras (padrão: desligado)
+//   --sim-thread      executa a física em uma thread própria, de modo que
+//                     atrasos na renderização não atrasam a simulação
+//   --tick-rate HZ    passos de física por segundo (padrão: 1000); o
+//                     desenho é interpolado entre os passos
+//   --input-rate HZ   lê o teclado HZ vezes por segundo entre os frames, e
+//                     não só uma vez por frame (ex.: 1000); com --sim-thread,
+//                     os flippers deixam de depender da taxa de quadros
+Options parseOptions(std::span<char *> args) {
+  Options options;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    std::string_view const arg{args[i]};
+    if (arg == "--sim-thread") {
+      options.threadedSimulation = true;
+      continue;
+    }
+    if (i + 1 >= args.size())
+      throw abcg::RuntimeError(fmt::format("Missing value for {}", arg));
+
+    if (arg == "--record")
+      options.session.recordPath = args[++i];
+    else if (arg == "--replay")
+      options.session.replayPath = args[++i];
+    else if (arg == "--patient")
+      options.session.patient = args[++i];
+    else if (arg == "--store")
+      options.session.storePath = args[++i];
+    else if (arg == "--telemetry")
+      options.session.telemetryPath = args[++i];
+    else if (arg == "--samples")
+      options.samples = std::stoi(args[++i]);
+    else if (arg == "--tick-rate")
+      options.tickRate = std::stod(args[++i]);
+    else if (arg == "--input-rate")
+      options.inputRate = std::stoi(args[++i]);
+    else
+      throw abcg::RuntimeError(fmt::format("Unknown option: {}", arg));
+  }
+  if (options.session.patient.size() > SessionStore::maxPatientLength)
+    throw abcg::RuntimeError(
+        fmt::format("Patient id longer than {} characters",
+                    SessionStore::maxPatientLength));
+  return options;
+}
+
+} // namespace
+
 int main(int argc, char **argv) {
   try {
     abcg::Application app(argc, argv);
 
+    auto options{parseOptions(std::span{argv, static_cast<std::size_t>(argc)})};
+
     Window window;
-    window.setOpenGLSettings({.samples = 4});
+    window.setSessionSettings(std::move(options.session));
+    window.setThreadedSimulation(options.threadedSimulation);
+    if (options.tickRate)
+      window.setTickRate(*options.tickRate);
+    window.setOpenGLSettings({.samples = options.samples});
     window.setWindowSettings({
       .width = 600,
       .height = 800,
-      .title = "Pinball Game"
+      .title = "Pinball Game",
+      .inputSamplingRate = options.inputRate
     });
 
     app.run(window);
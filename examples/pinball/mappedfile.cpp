@@ -0,0 +1,60 @@
+#include "mappedfile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) && !defined(__EMSCRIPTEN__) || defined(__APPLE__)
+#define PINBALL_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::string const &path) {
+#if defined(PINBALL_HAS_MMAP)
+  auto const descriptor{::open(path.c_str(), O_RDONLY)};
+  if (descriptor < 0)
+    throw std::runtime_error("Failed to open " + path);
+
+  struct stat status {};
+  if (::fstat(descriptor, &status) != 0) {
+    ::close(descriptor);
+    throw std::runtime_error("Failed to read " + path);
+  }
+  m_size = static_cast<std::size_t>(status.st_size);
+
+  // mmap não aceita tamanho zero; um arquivo vazio fica sem mapeamento
+  if (m_size > 0) {
+    auto *address{
+        ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0)};
+    if (address == MAP_FAILED) {
+      ::close(descriptor);
+      throw std::runtime_error("Failed to map " + path);
+    }
+    m_address = address;
+    m_mapped = true;
+  }
+  // O mapeamento continua válido após fechar o descritor
+  ::close(descriptor);
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    throw std::runtime_error("Failed to open " + path);
+  m_buffer.resize(static_cast<std::size_t>(file.tellg()));
+  file.seekg(0);
+  file.read(reinterpret_cast<char *>(m_buffer.data()),
+            static_cast<std::streamsize>(m_buffer.size()));
+  if (!file)
+    throw std::runtime_error("Failed to read " + path);
+  m_address = m_buffer.data();
+  m_size = m_buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if defined(PINBALL_HAS_MMAP)
+  if (m_mapped)
+    ::munmap(const_cast<void *>(m_address), m_size);
+#endif
+}
@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_HPP_
+#define MAPPEDFILE_HPP_
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+
+// Arquivo mapeado em memória, somente para leitura. As páginas são carregadas
+// sob demanda pelo sistema operacional e compartilhadas entre processos. Onde
+// não há mmap (Windows, Emscripten), o arquivo é lido inteiro para um buffer,
+// com a mesma interface.
+class MappedFile {
+public:
+  explicit MappedFile(std::string const &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  [[nodiscard]] std::span<std::byte const> getData() const noexcept {
+    return {static_cast<std::byte const *>(m_address), m_size};
+  }
+
+private:
+  void const *m_address{};
+  std::size_t m_size{};
+  bool m_mapped{};
+  std::vector<std::byte> m_buffer;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "mesh.hpp"
+
+Mesh Mesh::create(std::span<glm::vec2 const> vertices) {
+  Mesh mesh{.vertexCount = static_cast<GLsizei>(vertices.size())};
+
+  glGenBuffers(1, &mesh.VBO);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(vertices.size_bytes()),
+               vertices.data(), GL_STATIC_DRAW);
+
+  glGenVertexArrays(1, &mesh.VAO);
+  glBindVertexArray(mesh.VAO);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(0);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return mesh;
+}
+
+void Mesh::destroy() {
+  if (VAO != 0)
+    glDeleteVertexArrays(1, &VAO);
+  if (VBO != 0)
+    glDeleteBuffers(1, &VBO);
+  *this = {};
+}
@@ -0,0 +1,20 @@
+#ifndef MESH_HPP_
+#define MESH_HPP_
+
+#include "abcgOpenGL.hpp"
+#include <glm/vec2.hpp>
+#include <span>
+
+// Geometria enviada uma única vez para a GPU: um buffer de vértices 2D e o
+// VAO que descreve seu formato (atributo 0, vec2). Desenhar uma malha exige
+// apenas ligar o VAO; nenhum buffer é criado ou preenchido por frame.
+struct Mesh {
+  GLuint VAO{};
+  GLuint VBO{};
+  GLsizei vertexCount{};
+
+  static Mesh create(std::span<glm::vec2 const> vertices);
+  void destroy();
+};
+
+#endif
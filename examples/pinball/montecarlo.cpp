@@ -0,0 +1,232 @@
+#include "montecarlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+constexpr auto never{std::numeric_limits<std::uint64_t>::max()};
+
+// Intervalo, em passos, entre amostras da posição da bola
+constexpr std::uint64_t occupancyInterval{10};
+
+// Estado de um flipper controlado pela política
+struct FlipperControl {
+  bool isLeft{};
+  Simulation::Input down{};
+  Simulation::Input up{};
+  bool pressed{};
+  std::uint64_t pressAt{never};
+  std::uint64_t releaseAt{never};
+};
+
+class PolicyRunner {
+public:
+  PolicyRunner(EvaluationSettings const &settings, double tickRate,
+               std::mt19937 &gen)
+      : m_settings{settings}, m_tickRate{tickRate}, m_gen{gen} {
+    m_controls[0] = {.isLeft = true,
+                     .down = Simulation::Input::LeftFlipperDown,
+                     .up = Simulation::Input::LeftFlipperUp};
+    m_controls[1] = {.isLeft = false,
+                     .down = Simulation::Input::RightFlipperDown,
+                     .up = Simulation::Input::RightFlipperUp};
+
+    if (m_settings.policy == FlipperPolicy::Random) {
+      for (auto &control : m_controls) {
+        control.pressAt = randomWait(0);
+      }
+    }
+  }
+
+  void update(Simulation &simulation) {
+    if (m_settings.policy == FlipperPolicy::None)
+      return;
+
+    auto const tick{simulation.getTick()};
+    for (auto &control : m_controls) {
+      if (control.pressed && tick >= control.releaseAt) {
+        simulation.handleInput(control.up);
+        control.pressed = false;
+        control.releaseAt = never;
+        if (m_settings.policy == FlipperPolicy::Random)
+          control.pressAt = randomWait(tick);
+      }
+
+      if (!control.pressed && tick >= control.pressAt) {
+        simulation.handleInput(control.down);
+        control.pressed = true;
+        control.pressAt = never;
+        control.releaseAt = tick + toTicks(m_settings.holdTime);
+      }
+
+      if (m_settings.policy == FlipperPolicy::Reactive && !control.pressed &&
+          control.pressAt == never &&
+          inFlipperZone(simulation.getBall(), simulation, control.isLeft)) {
+        // Tempo de reação com 25% de variação entre tentativas
+        std::normal_distribution<double> reaction{m_settings.reactionTime,
+                                                  m_settings.reactionTime *
+                                                      0.25};
+        control.pressAt = tick + toTicks(std::max(reaction(m_gen), 0.0));
+      }
+    }
+  }
+
+private:
+  EvaluationSettings const &m_settings;
+  double m_tickRate;
+  std::mt19937 &m_gen;
+  std::array<FlipperControl, 2> m_controls{};
+
+  [[nodiscard]] std::uint64_t toTicks(double seconds) const {
+    return static_cast<std::uint64_t>(std::llround(seconds * m_tickRate));
+  }
+
+  std::uint64_t randomWait(std::uint64_t tick) {
+    std::exponential_distribution<double> wait{1.0 /
+                                               m_settings.randomInterval};
+    return tick + toTicks(wait(m_gen));
+  }
+
+  // A bola desce em direção ao flipper do seu lado da mesa
+  static bool inFlipperZone(Ball const &ball, Simulation const &simulation,
+                            bool isLeft) {
+    auto const &flipper{isLeft ? simulation.getLeftFlipper()
+                               : simulation.getRightFlipper()};
+    if (ball.velocity.y >= 0.0f || ball.position.y > flipper.position.y + 0.35f)
+      return false;
+    return isLeft ? ball.position.x < 0.0f : ball.position.x >= 0.0f;
+  }
+};
+
+} // namespace
+
+void Heatmap::add(glm::vec2 position) {
+  auto const cell = [](float value) {
+    auto const index{static_cast<int>(std::floor((value + 1.0f) * 0.5f *
+                                                 static_cast<float>(size)))};
+    return std::clamp(index, 0, size - 1);
+  };
+  ++m_cells[static_cast<std::size_t>(cell(position.y) * size +
+                                     cell(position.x))];
+}
+
+void Heatmap::merge(Heatmap const &other) {
+  for (std::size_t i = 0; i < m_cells.size(); ++i) {
+    m_cells[i] += other.m_cells[i];
+  }
+}
+
+std::uint32_t Heatmap::max() const {
+  return *std::max_element(m_cells.begin(), m_cells.end());
+}
+
+void Heatmap::saveCSV(std::string const &path) const {
+  std::ofstream file(path);
+  for (int y = size - 1; y >= 0; --y) {
+    for (int x = 0; x < size; ++x) {
+      file << get(x, y) << (x + 1 < size ? ',' : '\n');
+    }
+  }
+  if (!file)
+    throw std::runtime_error("Failed to write " + path);
+}
+
+void LayoutStats::merge(LayoutStats const &other) {
+  balls += other.balls;
+  drained += other.drained;
+  lifetimeTicks += other.lifetimeTicks;
+  flipperContacts += other.flipperContacts;
+  obstacleHits += other.obstacleHits;
+  wallHits += other.wallHits;
+  occupancy.merge(other.occupancy);
+  hits.merge(other.hits);
+}
+
+double LayoutStats::drainRate() const {
+  return balls > 0 ? static_cast<double>(drained) / static_cast<double>(balls)
+                   : 0.0;
+}
+
+double LayoutStats::meanLifetime(double tickRate) const {
+  return balls > 0 ? static_cast<double>(lifetimeTicks) /
+                         (static_cast<double>(balls) * tickRate)
+                   : 0.0;
+}
+
+double LayoutStats::drainsPerMinute(double tickRate) const {
+  auto const minutes{static_cast<double>(lifetimeTicks) / tickRate / 60.0};
+  return minutes > 0.0 ? static_cast<double>(drained) / minutes : 0.0;
+}
+
+double LayoutStats::flipperContactsPerMinute(double tickRate) const {
+  auto const minutes{static_cast<double>(lifetimeTicks) / tickRate / 60.0};
+  return minutes > 0.0 ? static_cast<double>(flipperContacts) / minutes : 0.0;
+}
+
+LayoutStats simulateBalls(Simulation const &prototype,
+                          EvaluationSettings const &settings,
+                          std::uint32_t layoutSeed, std::uint64_t firstBall,
+                          std::uint64_t count) {
+  LayoutStats stats;
+
+  auto simulation{prototype};
+  simulation.setCollisionEventsEnabled(true);
+
+  auto const tickRate{simulation.getTimestep().getTickRate()};
+  auto const launchVelocity{prototype.getLaunchVelocity()};
+  auto const maxTicks{
+      static_cast<std::uint64_t>(settings.maxBallSeconds * tickRate)};
+
+  for (auto ball = firstBall; ball < firstBall + count; ++ball) {
+    std::seed_seq seq{settings.seed, layoutSeed,
+                      static_cast<std::uint32_t>(ball),
+                      static_cast<std::uint32_t>(ball >> 32)};
+    std::mt19937 gen(seq);
+
+    // Pequena variação no lançamento para que as bolas sigam trajetórias
+    // diferentes mesmo com a política determinística
+    std::uniform_real_distribution<float> jitter{0.9f, 1.1f};
+    simulation.reset();
+    simulation.clearCollisionEvents();
+    simulation.setLaunchVelocity(
+        {launchVelocity.x * jitter(gen), launchVelocity.y * jitter(gen)});
+    simulation.handleInput(Simulation::Input::Launch);
+
+    PolicyRunner policy{settings, tickRate, gen};
+    while (simulation.isStarted() && simulation.getTick() < maxTicks) {
+      policy.update(simulation);
+      simulation.step();
+
+      if (simulation.getTick() % occupancyInterval == 0)
+        stats.occupancy.add(simulation.getBall().position);
+
+      for (auto const &event : simulation.getCollisionEvents()) {
+        switch (event.kind) {
+        case CollisionEvent::Kind::Flipper:
+          ++stats.flipperContacts;
+          break;
+        case CollisionEvent::Kind::Obstacle:
+          ++stats.obstacleHits;
+          break;
+        case CollisionEvent::Kind::Wall:
+          ++stats.wallHits;
+          break;
+        }
+        stats.hits.add(event.position);
+      }
+      simulation.clearCollisionEvents();
+    }
+
+    ++stats.balls;
+    stats.lifetimeTicks += simulation.getTick();
+    if (!simulation.isStarted())
+      ++stats.drained;
+  }
+
+  return stats;
+}
@@ -0,0 +1,84 @@
+#ifndef MONTECARLO_HPP_
+#define MONTECARLO_HPP_
+
+#include "simulation.hpp"
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <string>
+
+// Estratégia usada para acionar os flippers durante a avaliação
+enum class FlipperPolicy {
+  // Flippers sempre em repouso
+  None,
+  // Toques em intervalos aleatórios, sem olhar para a bola
+  Random,
+  // Aciona o flipper do lado da bola quando ela desce para a zona dos
+  // flippers, após um tempo de reação
+  Reactive
+};
+
+struct EvaluationSettings {
+  int ballsPerLayout{10000};
+  // Bolas ainda em jogo após este tempo são contadas como sobreviventes
+  double maxBallSeconds{30.0};
+  FlipperPolicy policy{FlipperPolicy::Reactive};
+  // Tempo de reação médio e duração do toque, em segundos
+  double reactionTime{0.2};
+  double holdTime{0.15};
+  // Intervalo médio entre toques da política aleatória, em segundos
+  double randomInterval{1.0};
+  std::uint32_t seed{1};
+};
+
+// Contagem de eventos em uma grade sobre a mesa ([-1, 1] x [-1, 1])
+class Heatmap {
+public:
+  static constexpr int size{32};
+
+  void add(glm::vec2 position);
+  void merge(Heatmap const &other);
+
+  [[nodiscard]] std::uint32_t get(int x, int y) const {
+    return m_cells[static_cast<std::size_t>(y * size + x)];
+  }
+  [[nodiscard]] std::uint32_t max() const;
+
+  // Grava a grade em CSV, com a linha do topo da mesa primeiro
+  void saveCSV(std::string const &path) const;
+
+private:
+  std::array<std::uint32_t, size * size> m_cells{};
+};
+
+// Resultados acumulados de um layout
+struct LayoutStats {
+  std::uint64_t balls{};
+  std::uint64_t drained{};
+  // Soma dos tempos de vida das bolas, em passos
+  std::uint64_t lifetimeTicks{};
+  std::uint64_t flipperContacts{};
+  std::uint64_t obstacleHits{};
+  std::uint64_t wallHits{};
+  // Posições da bola amostradas e pontos de colisão
+  Heatmap occupancy;
+  Heatmap hits;
+
+  void merge(LayoutStats const &other);
+
+  [[nodiscard]] double drainRate() const;
+  [[nodiscard]] double meanLifetime(double tickRate) const;
+  [[nodiscard]] double drainsPerMinute(double tickRate) const;
+  [[nodiscard]] double flipperContactsPerMinute(double tickRate) const;
+};
+
+// Joga count bolas, a partir da bola firstBall, no layout de prototype. Cada
+// bola usa um gerador próprio derivado da semente, do layout e do índice da
+// bola, de modo que o resultado não depende de como as bolas são divididas
+// entre as threads.
+LayoutStats simulateBalls(Simulation const &prototype,
+                          EvaluationSettings const &settings,
+                          std::uint32_t layoutSeed, std::uint64_t firstBall,
+                          std::uint64_t count);
+
+#endif
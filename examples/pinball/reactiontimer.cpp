@@ -0,0 +1,115 @@
+#include "reactiontimer.hpp"
+#include <algorithm>
+#include <numeric>
+
+TriggerZone TriggerZone::fromTable(Table const &table) {
+  auto const &left{table.getLeftFlipper()};
+  auto const &right{table.getRightFlipper()};
+  return {.lineY = std::max(left.pivot.y, right.pivot.y) + triggerHeight,
+          .minX = left.pivot.x,
+          .maxX = right.pivot.x};
+}
+
+bool TriggerZone::crossed(glm::vec2 previous,
+                          glm::vec2 current) const noexcept {
+  return previous.y > lineY && current.y <= lineY && current.x >= minX &&
+         current.x <= maxX;
+}
+
+std::optional<ReactionTimer::Clock::duration>
+ReactionTimer::Attempt::displayLatency() const noexcept {
+  if (!latency)
+    return std::nullopt;
+  if (!displayDelay)
+    return latency;
+  // Uma resposta antes da exibição estimada é uma antecipação, e a tentativa
+  // fica sem resposta
+  if (*latency < *displayDelay)
+    return std::nullopt;
+  return *latency - *displayDelay;
+}
+
+ReactionTimer::ReactionTimer(Clock::duration maxLatency)
+    : m_maxLatency{maxLatency} {}
+
+void ReactionTimer::stimulus(Clock::time_point time) {
+  m_attempts.push_back({.stimulus = time, .latency = std::nullopt,
+                        .displayDelay = std::nullopt});
+  m_waiting = true;
+}
+
+std::optional<ReactionTimer::Clock::duration>
+ReactionTimer::respond(Clock::time_point time) {
+  if (!m_waiting)
+    return std::nullopt;
+
+  // Uma entrada marcada antes do estímulo é uma antecipação e não fecha a
+  // tentativa. Com a exibição do estímulo já estimada, vale o instante em que
+  // ele apareceu na tela
+  auto &attempt{m_attempts.back()};
+  auto const shown{attempt.stimulus +
+                   attempt.displayDelay.value_or(Clock::duration{})};
+  if (time < shown)
+    return std::nullopt;
+
+  m_waiting = false;
+  auto const latency{time - attempt.stimulus};
+  if (latency > m_maxLatency)
+    return std::nullopt;
+  attempt.latency = latency;
+  return latency;
+}
+
+void ReactionTimer::expire(Clock::time_point now) {
+  if (m_waiting && now - m_attempts.back().stimulus > m_maxLatency)
+    m_waiting = false;
+}
+
+void ReactionTimer::presented(std::size_t attempt, Clock::time_point time) {
+  if (attempt >= m_attempts.size())
+    return;
+  auto &target{m_attempts[attempt]};
+  target.displayDelay = std::max(time - target.stimulus, Clock::duration{});
+}
+
+void ReactionTimer::clear() {
+  m_attempts.clear();
+  m_waiting = false;
+}
+
+ReactionTimer::Summary ReactionTimer::summarize() const {
+  std::vector<Clock::duration> latencies;
+  Clock::duration displayDelays{};
+  std::size_t corrected{};
+  for (auto const &attempt : m_attempts) {
+    auto const latency{attempt.displayLatency()};
+    if (!latency)
+      continue;
+    latencies.push_back(*latency);
+    if (attempt.displayDelay) {
+      displayDelays += *attempt.displayDelay;
+      ++corrected;
+    }
+  }
+
+  Summary summary{.attempts = m_attempts.size(),
+                  .responses = latencies.size(),
+                  .corrected = corrected};
+  if (latencies.empty())
+    return summary;
+
+  if (corrected > 0)
+    summary.meanDisplayDelay =
+        displayDelays / static_cast<Clock::rep>(corrected);
+  std::sort(latencies.begin(), latencies.end());
+  auto const total{std::accumulate(latencies.begin(), latencies.end(),
+                                   Clock::duration{})};
+  summary.mean = total / static_cast<Clock::rep>(latencies.size());
+  auto const middle{latencies.size() / 2};
+  summary.median = latencies.size() % 2 == 1
+                       ? latencies[middle]
+                       : (latencies[middle - 1] + latencies[middle]) / 2;
+  summary.min = latencies.front();
+  summary.max = latencies.back();
+  return summary;
+}
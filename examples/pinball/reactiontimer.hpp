@@ -0,0 +1,104 @@
+#ifndef REACTIONTIMER_HPP_
+#define REACTIONTIMER_HPP_
+
+#include "table.hpp"
+#include <chrono>
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <optional>
+#include <vector>
+
+// Zona de disparo do estímulo: a linha horizontal a triggerHeight acima dos
+// pivôs dos flippers, entre eles. O estímulo é a bola cruzar a linha para
+// baixo, a caminho dos flippers
+struct TriggerZone {
+  static constexpr float triggerHeight{0.3f};
+
+  float lineY{};
+  float minX{};
+  float maxX{};
+
+  static TriggerZone fromTable(Table const &table);
+
+  // Se a bola, desenhada em previous no frame anterior e em current neste,
+  // cruzou a linha para baixo
+  [[nodiscard]] bool crossed(glm::vec2 previous,
+                             glm::vec2 current) const noexcept;
+};
+
+// Mede o tempo de reação do jogador: do estímulo (o frame em que a bola
+// entra na zona de disparo) até a primeira entrada de flipper seguinte.
+//
+// Os instantes vêm de std::chrono::steady_clock, com a resolução do relógio
+// (em geral, nanossegundos), e não dos timestamps dos eventos do SDL, que são
+// em milissegundos. As entradas são marcadas por abcg::Window::getEventTime
+// assim que o SDL as entrega.
+//
+// Cada estímulo abre uma tentativa, fechada pela primeira resposta em até
+// maxLatency; sem resposta nesse prazo, ou se outro estímulo vier antes, a
+// tentativa fica sem latência. Respostas sem tentativa aberta (antecipações
+// ou toques repetidos) são ignoradas.
+//
+// O estímulo é marcado quando o frame é montado, antes de ele chegar à tela.
+// Com presented, o instante estimado em que o frame do estímulo foi exibido
+// (abcg::OpenGLFrameTimer), a latência da tentativa passa a ser contada a
+// partir dele, sem o tempo de desenho, da fila de frames e da espera pelo
+// retraço vertical.
+class ReactionTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Attempt {
+    Clock::time_point stimulus{};
+    // Vazia se não houve resposta
+    std::optional<Clock::duration> latency;
+    // Do estímulo até a exibição do seu frame; vazia se não foi estimada
+    std::optional<Clock::duration> displayDelay;
+
+    // Latência a partir da exibição do estímulo, ou a partir do estímulo se
+    // a exibição não foi estimada. Vazia se não houve resposta ou se ela veio
+    // antes da exibição (estimada depois da resposta)
+    [[nodiscard]] std::optional<Clock::duration>
+    displayLatency() const noexcept;
+  };
+
+  // Estatísticas das tentativas com resposta, com as latências a partir da
+  // exibição do estímulo (Attempt::displayLatency)
+  struct Summary {
+    std::size_t attempts{};
+    std::size_t responses{};
+    // Respostas com a exibição estimada, e a média do atraso de exibição
+    std::size_t corrected{};
+    Clock::duration meanDisplayDelay{};
+    Clock::duration mean{};
+    Clock::duration median{};
+    Clock::duration min{};
+    Clock::duration max{};
+  };
+
+  explicit ReactionTimer(Clock::duration maxLatency = std::chrono::seconds{1});
+
+  void stimulus(Clock::time_point time);
+  // Registra uma resposta e retorna a latência, se ela fechou uma tentativa
+  std::optional<Clock::duration> respond(Clock::time_point time);
+  // Fecha sem resposta a tentativa aberta cujo prazo terminou antes de now
+  void expire(Clock::time_point now);
+  // Registra o instante em que o frame do estímulo da tentativa de índice
+  // attempt foi exibido
+  void presented(std::size_t attempt, Clock::time_point time);
+  void clear();
+
+  [[nodiscard]] std::vector<Attempt> const &getAttempts() const noexcept {
+    return m_attempts;
+  }
+  [[nodiscard]] bool isWaiting() const noexcept { return m_waiting; }
+  [[nodiscard]] Summary summarize() const;
+
+private:
+  Clock::duration m_maxLatency;
+  std::vector<Attempt> m_attempts;
+  // Se a última tentativa ainda aceita uma resposta
+  bool m_waiting{false};
+};
+
+#endif
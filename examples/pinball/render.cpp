@@ -1,196 +1,217 @@
 #include "render.hpp"
-#include <glm/gtx/rotate_vector.hpp>
-#include <vector>
-
-// Renderiza os obstáculos circulares do jogo
-void Render::renderObstacles(Window &window, glm::vec2 const &position,
-                             float radius) {
-  glBindVertexArray(window.m_VAO);
-
-  // Define o número de triângulos para formar o círculo
-  static const int numTriangles = 20;
-  std::vector<glm::vec2> positions;
-  positions.emplace_back(0, 0); // Centro do círculo
-
-  // Gera pontos em arranjo circular para formar o obstáculo
-  for (int i = 0; i <= numTriangles; i++) {
-    auto const angle = i * M_PI * 2.0f / numTriangles;
-    positions.emplace_back(radius * std::cos(angle), radius * std::sin(angle));
-  }
-
-  // Define a cor do obstáculo como branco
-  glUniform4f(window.m_colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
-
-  // Configura a posição do obstáculo
-  glUniform2f(window.m_translateLoc, position.x, position.y);
-  glUniform1f(window.m_rotateLoc, 0.0f);
-  glUniform1f(window.m_scaleLoc, window.m_gameScale);
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+
+namespace {
+// Primeiro vértice de cada flipper na malha dos flippers
+constexpr GLint leftFlipperFirst{0};
+constexpr GLint rightFlipperFirst{4};
+constexpr GLsizei flipperVertices{4};
+
+// Quadrilátero da cápsula usada nas colisões, em coordenadas do mundo e com
+// o pivô na origem; o flipper direito aponta para -x
+std::array<glm::vec2, 4> flipperQuad(TableFlipper const &flipper,
+                                     bool isLeft) {
+  float const halfHeight{flipper.radius};
+  float const length{isLeft ? flipper.length : -flipper.length};
+  return {glm::vec2{0.0f, -halfHeight}, glm::vec2{length, -halfHeight},
+          glm::vec2{length, halfHeight}, glm::vec2{0.0f, halfHeight}};
+}
 
-  // Cria e configura o buffer de vértices (VBO)
-  GLuint VBO{};
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-               positions.data(), GL_STATIC_DRAW);
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glEnableVertexAttribArray(0);
+// Grupos da lista de desenho: os polígonos (mesa e flippers) ficam por baixo
+// dos círculos (obstáculos e bolas)
+constexpr std::uint8_t polygonGroup{0};
+constexpr std::uint8_t circleGroup{1};
+} // namespace
+
+// Cria o quadrado que envolve o círculo de raio unitário, compartilhado pela
+// bola, pelas bolas da multibola e pelos obstáculos (o raio de cada um é um
+// atributo da instância), e a geometria da mesa. O círculo em si é calculado
+// no shader de fragmento, de modo que a borda é nítida em qualquer escala
+void Render::createMeshes(Window &window) {
+  std::array<glm::vec2, 4> const quad{
+      glm::vec2{-1.0f, -1.0f}, glm::vec2{1.0f, -1.0f}, glm::vec2{-1.0f, 1.0f},
+      glm::vec2{1.0f, 1.0f}};
+  window.m_circleMesh = Mesh::create(quad);
+  // O mesmo quadrado cobre a tela inteira na cópia da camada estática
+  window.m_screenQuadMesh = Mesh::create(quad);
+
+  createTable(window);
+}
 
-  // Desenha o obstáculo usando TRIANGLE_FAN para criar um círculo preenchido
-  glDrawArrays(GL_TRIANGLE_FAN, 0, positions.size());
+void Render::destroyMeshes(Window &window) {
+  window.m_circleMesh.destroy();
+  window.m_flipperMesh.destroy();
+  window.m_tableMesh.destroy();
+  window.m_screenQuadMesh.destroy();
+  window.m_staticLayer.destroy();
+}
 
-  // Limpa o buffer após uso
-  glDeleteBuffers(1, &VBO);
+// Envia a geometria da mesa e dos flippers para a GPU
+void Render::createTable(Window &window) {
+  auto const &table{window.m_simulation.getTable()};
+
+  auto const left{flipperQuad(table.getLeftFlipper(), true)};
+  auto const right{flipperQuad(table.getRightFlipper(), false)};
+  std::array<glm::vec2, 2 * flipperVertices> flippers{};
+  std::copy(left.begin(), left.end(), flippers.begin() + leftFlipperFirst);
+  std::copy(right.begin(), right.end(), flippers.begin() + rightFlipperFirst);
+  window.m_flipperMesh.destroy();
+  window.m_flipperMesh = Mesh::create(flippers);
+
+  auto const mesh{table.tessellate()};
+  window.m_tableMesh.destroy();
+  window.m_tableMesh = Mesh::create(mesh.vertices);
+  window.m_tableLineVertices = static_cast<GLsizei>(mesh.lineVertices);
+  window.m_tableFanSize = static_cast<GLsizei>(mesh.fanSize);
+  window.m_tableFanCount = static_cast<GLsizei>(mesh.fanCount);
 }
 
 // Renderiza os flippers (pás) do pinball
 void Render::renderFlipper(Window &window, Flipper const &flipper,
                            bool isLeft) {
-  glBindVertexArray(window.m_VAO);
-
-  const float flipperHalfHeight = -0.1f;
-
-  // Define os vértices do flipper baseado em sua orientação (esquerda ou
-  // direita)
-  std::array<glm::vec2, 4> positions;
-  if (isLeft) {
-    positions = {
-        glm::vec2{0.0f, -flipperHalfHeight},
-        glm::vec2{flipper.length / window.m_gameScale, -flipperHalfHeight},
-        glm::vec2{flipper.length / window.m_gameScale, flipperHalfHeight},
-        glm::vec2{0.0f, flipperHalfHeight}};
-  } else {
-    positions = {
-        glm::vec2{0.0f, -flipperHalfHeight},
-        glm::vec2{-flipper.length / window.m_gameScale, -flipperHalfHeight},
-        glm::vec2{-flipper.length / window.m_gameScale, flipperHalfHeight},
-        glm::vec2{0.0f, flipperHalfHeight}};
+  // Cor (branco) e transformações do flipper
+  auto const currentAngle{glm::mix(flipper.previousAngle, flipper.currentAngle,
+                                   window.m_frameInterpolation)};
+  float angle = isLeft ? currentAngle : -currentAngle;
+  auto const object{window.m_drawList.addObject(
+      {.translate = flipper.position, .rotate = angle})};
+
+  // Desenha o flipper como um polígono preenchido
+  window.m_drawList.draw(polygonGroup, window.m_program, window.m_flipperMesh,
+                         GL_TRIANGLE_FAN,
+                         isLeft ? leftFlipperFirst : rightFlipperFirst,
+                         flipperVertices, object);
+}
+
+// Obstáculos em branco
+void Render::renderObstacles(Window &window) {
+  auto &instances{window.m_circleInstances};
+  instances.clear();
+  for (auto const &obstacle : window.m_frame->obstacles) {
+    instances.push_back({.position = obstacle.position,
+                         .radius = obstacle.radius * window.m_gameScale,
+                         .color = {1.0f, 1.0f, 1.0f, 1.0f}});
+  }
+  window.m_drawList.drawCircles(circleGroup, window.m_circleProgram,
+                                window.m_circleMesh, instances);
+}
+
+// Bolas, desenhadas entre as posições dos dois últimos passos da física
+void Render::renderBalls(Window &window) {
+  auto &instances{window.m_circleInstances};
+  instances.clear();
+
+  auto const &frame{*window.m_frame};
+  auto const alpha{window.m_frameInterpolation};
+
+  // Bolas da multibola em laranja, para diferenciar da bola principal
+  for (std::size_t i = 0; i < frame.multiBallPositions.size(); ++i) {
+    auto const position{glm::mix(frame.multiBallPreviousPositions[i],
+                                 frame.multiBallPositions[i], alpha)};
+    instances.push_back({.position = position,
+                         .radius = frame.multiBallRadii[i],
+                         .color = {1.0f, 0.5f, 0.0f, 1.0f}});
   }
 
-  // Configura cor (branco) e transformações do flipper
-  glUniform4f(window.m_colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
-  glUniform2f(window.m_translateLoc, flipper.position.x, flipper.position.y);
-  float angle = isLeft ? flipper.currentAngle : -flipper.currentAngle;
-  glUniform1f(window.m_rotateLoc, angle);
-  glUniform1f(window.m_scaleLoc, window.m_gameScale);
-
-  // Cria e configura o buffer de vértices
-  GLuint VBO{};
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-               positions.data(), GL_STATIC_DRAW);
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glEnableVertexAttribArray(0);
+  // Bola em vermelho, por último para ficar por cima
+  auto const &ball{frame.ball};
+  instances.push_back({.position = glm::mix(ball.previousPosition,
+                                            ball.position, alpha),
+                       .radius = ball.radius * window.m_gameScale,
+                       .color = {1.0f, 0.0f, 0.0f, 1.0f}});
 
-  // Desenha o flipper como um polígono preenchido
-  glDrawArrays(GL_TRIANGLE_FAN, 0, positions.size());
+  window.m_drawList.drawCircles(circleGroup, window.m_circleProgram,
+                                window.m_circleMesh, instances);
+}
 
-  glDeleteBuffers(1, &VBO);
+// Renderiza a mesa (paredes, arcos e bumpers) a partir da malha criada por
+// createTable, já em coordenadas do mundo
+void Render::renderTable(Window &window) {
+  auto &drawList{window.m_drawList};
+  auto const &mesh{window.m_tableMesh};
+
+  // Paredes e arcos em cinza
+  auto const walls{drawList.addObject({.color = {0.5f, 0.5f, 0.5f, 1.0f}})};
+  drawList.draw(polygonGroup, window.m_program, mesh, GL_LINES, 0,
+                window.m_tableLineVertices, walls);
+
+  // Bumpers em branco, como os obstáculos; todos usam o mesmo objeto
+  auto const bumpers{drawList.addObject({.color = {1.0f, 1.0f, 1.0f, 1.0f}})};
+  for (GLsizei i = 0; i < window.m_tableFanCount; ++i) {
+    drawList.draw(polygonGroup, window.m_program, mesh, GL_TRIANGLE_FAN,
+                  window.m_tableLineVertices + i * window.m_tableFanSize,
+                  window.m_tableFanSize, bumpers);
+  }
 }
 
-// Renderiza a bola do pinball
-void Render::renderBall(Window &window) {
-  glBindVertexArray(window.m_VAO);
+// A camada é redesenhada só quando o tamanho da tela ou o layout mudam; nos
+// demais frames, o custo é o de um quadrado texturizado, qualquer que seja o
+// número de paredes, bumpers e obstáculos
+void Render::renderStaticLayer(Window &window) {
+  auto const size{window.m_viewportSize};
+  if (size.x <= 0 || size.y <= 0)
+    return;
+
+  auto &layer{window.m_staticLayer};
+  if (layer.size != size) {
+    layer.destroy();
+    layer = StaticLayer::create(size, window.getOpenGLSettings().samples);
+  }
 
-  // Cria uma aproximação circular usando triângulos
-  static const int numTriangles = 20;
-  std::vector<glm::vec2> positions;
-  positions.emplace_back(0, 0); // Centro da bola
+  if (auto const version{window.m_frame->layoutVersion};
+      layer.layoutVersion != version) {
+    GLint screenFramebuffer{};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screenFramebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.drawFramebuffer());
+    glClear(GL_COLOR_BUFFER_BIT);
+    renderTable(window);
+    renderObstacles(window);
+    window.m_drawList.flush();
+    layer.resolve();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(screenFramebuffer));
+    layer.layoutVersion = version;
+  }
+
+  glUseProgram(window.m_layerProgram);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, layer.texture);
+  glBindVertexArray(window.m_screenQuadMesh.VAO);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, window.m_screenQuadMesh.vertexCount);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-  // Gera pontos em círculo para formar a bola
-  for (int i = 0; i <= numTriangles; i++) {
-    auto const angle = i * M_PI * 2.0f / numTriangles;
-    positions.emplace_back(window.m_ball.radius * std::cos(angle),
-                           window.m_ball.radius * std::sin(angle));
+// Cada impacto gera uma explosão de partículas no ponto de contato, maior e
+// mais rápida quanto mais forte o impacto. As colisões com as paredes não
+// geram partículas
+void Render::emitParticles(Window &window, CollisionEvent const &event) {
+  glm::vec4 color{};
+  switch (event.kind) {
+  case CollisionEvent::Kind::Obstacle:
+    color = {1.0f, 0.85f, 0.3f, 1.0f};
+    break;
+  case CollisionEvent::Kind::Flipper:
+    color = {0.3f, 0.8f, 1.0f, 1.0f};
+    break;
+  case CollisionEvent::Kind::Wall:
+    return;
   }
 
-  // Define a cor da bola como vermelho e configura transformações
-  glUniform4f(window.m_colorLoc, 1.0f, 0.0f, 0.0f, 1.0f);
-  glUniform2f(window.m_translateLoc, window.m_ball.position.x,
-              window.m_ball.position.y);
-  glUniform1f(window.m_rotateLoc, 0.0f);
-  glUniform1f(window.m_scaleLoc, window.m_gameScale);
-
-  // Configura buffer de vértices
-  GLuint VBO{};
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-               positions.data(), GL_STATIC_DRAW);
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glEnableVertexAttribArray(0);
-
-  // Desenha a bola como um círculo preenchido
-  glDrawArrays(GL_TRIANGLE_FAN, 0, positions.size());
-
-  glDeleteBuffers(1, &VBO);
+  auto const strength{std::clamp(event.impactSpeed, 0.25f, 4.0f)};
+  window.m_particles.emit(
+      {.position = event.position,
+       .speed = 0.3f + 0.4f * strength,
+       .lifetime = 0.6f,
+       .count = static_cast<std::size_t>(1500.0f * strength),
+       .color = color});
 }
 
-// Renderiza as paredes e limites do campo de jogo
-void Render::renderWalls(Window &window) {
-  glBindVertexArray(window.m_VAO);
-
-  // Define os vértices das paredes com uma abertura no canto superior direito
-  std::vector<glm::vec2> positions{
-      // Parede esquerda
-      {WALL_LEFT, WALL_BOTTOM},
-      {WALL_LEFT + 0.1f, WALL_BOTTOM},
-      {WALL_LEFT + 0.1f, WALL_TOP},
-      {WALL_LEFT, WALL_TOP},
-
-      // Parede direita com abertura próxima ao topo
-      {WALL_RIGHT - 0.1f, WALL_BOTTOM},
-      {WALL_RIGHT, WALL_BOTTOM},
-      {WALL_RIGHT, WALL_TOP - 0.3f}, // Início da abertura
-      {WALL_RIGHT - 0.1f, WALL_TOP - 0.3f},
-
-      // Continuação da parede direita após a abertura
-      {WALL_RIGHT - 0.1f, WALL_TOP - 0.1f},
-      {WALL_RIGHT, WALL_TOP - 0.1f},
-
-      // Parede superior
-      {WALL_LEFT + 0.1f, WALL_TOP - 0.1f},
-      {WALL_RIGHT - 0.1f, WALL_TOP - 0.1f},
-  };
-
-  // Adiciona seções fixas da parede inferior atrás dos flippers
-  positions.push_back(
-      {WALL_LEFT, WALL_BOTTOM - 2.0f}); // Início da parede inferior esquerda
-  positions.push_back(
-      {WALL_LEFT, WALL_BOTTOM + 0.2f}); // Fim da parede inferior esquerda
-  positions.push_back(
-      {m_leftFlipper.position.x,
-       m_leftFlipper.position.y}); // Posição do flipper esquerdo
-
-  positions.push_back(
-      {WALL_RIGHT, WALL_BOTTOM - 2.0f}); // Início da parede inferior direita
-  positions.push_back(
-      {WALL_RIGHT, WALL_BOTTOM + 0.2f}); // Fim da parede inferior direita
-  positions.push_back(
-      {m_rightFlipper.position.x,
-       m_rightFlipper.position.y}); // Posição do flipper direito
-
-  // Configura cor cinza para as paredes e suas transformações
-  glUniform4f(window.m_colorLoc, 0.5f, 0.5f, 0.5f, 1.0f);
-  glUniform2f(window.m_translateLoc, 0.0f, 0.0f);
-  glUniform1f(window.m_rotateLoc, 0.0f);
-  glUniform1f(window.m_scaleLoc, 1.0f);
-
-  // Configura buffer de vértices
-  GLuint VBO{};
-  glGenBuffers(1, &VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-               positions.data(), GL_STATIC_DRAW);
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glEnableVertexAttribArray(0);
-
-  // Desenha cada seção das paredes como um loop de linhas separado
-  glDrawArrays(GL_LINE_LOOP, 0, 4); // Parede esquerda
-  glDrawArrays(GL_LINE_LOOP, 4, 4); // Parede direita com abertura
-  glDrawArrays(GL_LINE_LOOP, 8, 4); // Parede superior
-  glDrawArrays(GL_LINE_LOOP, 12,
-               6); // Parede inferior com abertura fixa tipo fosso
-
-  glDeleteBuffers(1, &VBO);
+void Render::renderParticles(Window &window, float deltaTime) {
+  window.m_particles.update(deltaTime);
+  window.m_particles.render();
 }
\ No newline at end of file
@@ -6,12 +6,31 @@
 
 class Render {
 public:
-  static void renderBall(Window &window);
+  // Cria as malhas do jogo na GPU; chamada uma única vez, em onCreate
+  static void createMeshes(Window &window);
+  static void destroyMeshes(Window &window);
+  // Refaz as malhas da mesa e dos flippers, se a mesa da simulação mudar
+  static void createTable(Window &window);
+
+  // As rotinas a seguir só gravam comandos em window.m_drawList; o desenho
+  // acontece em DrawList::flush
   static void renderFlipper(Window &window, Flipper const &flipper,
                             bool isLeft);
-  static void renderWalls(Window &window);
-  static void renderObstacles(Window &window, glm::vec2 const &position,
-                              float radius);
+  static void renderTable(Window &window);
+  // Obstáculos em uma única chamada instanciada; usa o programa de círculos
+  static void renderObstacles(Window &window);
+  // Bolas da multibola e bola, nessa ordem, em uma única chamada instanciada;
+  // usa o programa de círculos
+  static void renderBalls(Window &window);
+  // Copia a camada estática (fundo, mesa e obstáculos) para a tela,
+  // redesenhando-a antes se o tamanho da tela ou o layout mudaram. Executa a
+  // lista de desenho no framebuffer da camada, que deve estar vazia
+  static void renderStaticLayer(Window &window);
+
+  // Partículas de realce das colisões com obstáculos e flippers, simuladas e
+  // desenhadas inteiramente na GPU (abcg::OpenGLParticleSystem)
+  static void emitParticles(Window &window, CollisionEvent const &event);
+  static void renderParticles(Window &window, float deltaTime);
 };
 
 #endif // RENDER_HPP
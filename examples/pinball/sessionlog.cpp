@@ -0,0 +1,209 @@
+#include "sessionlog.hpp"
+#include "bytestream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> logMagic{'P', 'B', 'L', 'G'};
+// Versão 2: mesa gravada no registro, e a física da mesa descrita em arquivo
+// e do contato com os flippers pela velocidade angular. Os registros da
+// versão 1 não reproduzem com a física atual e são recusados
+constexpr std::uint16_t logVersion{2};
+// Marca o fim dos eventos no lugar do tipo de entrada
+constexpr std::uint8_t endMarker{0xFF};
+
+} // namespace
+
+SessionLog SessionLog::begin(Simulation const &simulation) {
+  SessionLog log;
+  log.table = simulation.getTable();
+  log.seed = simulation.getSeed();
+  log.tickRate = simulation.getTimestep().getTickRate();
+  log.multiBallCount = simulation.getMultiBallCount();
+  log.obstacles = simulation.getObstacles();
+  log.endTick = simulation.getTick();
+  return log;
+}
+
+void SessionLog::record(Simulation const &simulation, Simulation::Input input,
+                        std::uint32_t timestamp) {
+  events.push_back({.tick = simulation.getTick(),
+                    .input = input,
+                    .timestamp = timestamp});
+  endTick = simulation.getTick();
+}
+
+void SessionLog::finish(Simulation const &simulation) {
+  endTick = simulation.getTick();
+}
+
+void SessionLog::apply(Simulation &simulation) const {
+  simulation.setTable(table);
+  simulation.getTimestep().setTickRate(tickRate);
+  simulation.setMultiBallCount(multiBallCount);
+  simulation.setObstacles(obstacles, seed);
+  simulation.reset();
+}
+
+std::vector<std::uint8_t> SessionLog::encode() const {
+  std::vector<std::uint8_t> data;
+  auto const tableData{table.getData()};
+  data.reserve(32 + tableData.size() + obstacles.size() * 12 +
+               events.size() * 3);
+  ByteWriter writer{data};
+
+  for (auto const byte : logMagic) {
+    writer.bytes(byte, 1);
+  }
+  writer.bytes(logVersion, 2);
+  writer.varint(tableData.size());
+  for (auto const byte : tableData) {
+    writer.bytes(static_cast<std::uint8_t>(byte), 1);
+  }
+  writer.bytes(seed, 4);
+  writer.bytes(std::bit_cast<std::uint64_t>(tickRate), 8);
+  writer.varint(static_cast<std::uint64_t>(std::max(multiBallCount, 0)));
+
+  writer.varint(obstacles.size());
+  for (auto const &obstacle : obstacles) {
+    writer.real(obstacle.position.x);
+    writer.real(obstacle.position.y);
+    writer.real(obstacle.radius);
+  }
+
+  std::uint64_t tick{};
+  std::uint32_t timestamp{events.empty() ? 0 : events.front().timestamp};
+  writer.bytes(timestamp, 4);
+  for (auto const &event : events) {
+    writer.bytes(static_cast<std::uint8_t>(event.input), 1);
+    writer.varint(event.tick - tick);
+    // Diferença módulo 2^32: o contador do SDL pode dar a volta
+    writer.varint(static_cast<std::uint32_t>(event.timestamp - timestamp));
+    tick = event.tick;
+    timestamp = event.timestamp;
+  }
+  writer.bytes(endMarker, 1);
+  writer.varint(endTick - tick);
+
+  return data;
+}
+
+SessionLog SessionLog::decode(std::span<std::uint8_t const> data) {
+  if (data.size() < logMagic.size() ||
+      !std::equal(logMagic.begin(), logMagic.end(), data.begin()))
+    throw std::runtime_error("Not a session log");
+
+  ByteReader reader{data.subspan(logMagic.size()), "session log"};
+  if (auto const version{reader.bytes(2)}; version != logVersion)
+    throw std::runtime_error("Unsupported session log version");
+
+  SessionLog log;
+  auto const tableData{reader.span(reader.varint())};
+  log.table = Table::fromData(std::as_bytes(tableData));
+  log.seed = static_cast<std::uint32_t>(reader.bytes(4));
+  log.tickRate = std::bit_cast<double>(reader.bytes(8));
+  log.multiBallCount = static_cast<int>(reader.varint());
+
+  auto const obstacleCount{reader.varint()};
+  if (obstacleCount > data.size())
+    throw std::runtime_error("Truncated session log");
+  log.obstacles.reserve(obstacleCount);
+  for (std::uint64_t i = 0; i < obstacleCount; ++i) {
+    Obstacle obstacle{};
+    obstacle.position.x = reader.real();
+    obstacle.position.y = reader.real();
+    obstacle.radius = reader.real();
+    log.obstacles.push_back(obstacle);
+  }
+
+  std::uint64_t tick{};
+  auto timestamp{static_cast<std::uint32_t>(reader.bytes(4))};
+  while (true) {
+    auto const type{static_cast<std::uint8_t>(reader.bytes(1))};
+    tick += reader.varint();
+    if (type == endMarker)
+      break;
+    if (type > static_cast<std::uint8_t>(Simulation::Input::MultiBall))
+      throw std::runtime_error("Invalid input in session log");
+
+    timestamp += static_cast<std::uint32_t>(reader.varint());
+    log.events.push_back({.tick = tick,
+                          .input = static_cast<Simulation::Input>(type),
+                          .timestamp = timestamp});
+  }
+  log.endTick = tick;
+
+  return log;
+}
+
+void SessionLog::save(std::string const &path) const {
+  auto const data{encode()};
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<char const *>(data.data()),
+             static_cast<std::streamsize>(data.size()));
+  if (!file)
+    throw std::runtime_error("Failed to write session log " + path);
+}
+
+SessionLog SessionLog::load(std::string const &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Failed to open session log " + path);
+  std::vector<std::uint8_t> const data{std::istreambuf_iterator<char>(file),
+                                       std::istreambuf_iterator<char>()};
+  return decode(data);
+}
+
+SessionPlayer::SessionPlayer(SessionLog log) : m_log{std::move(log)} {}
+
+void SessionPlayer::start(Simulation &simulation) {
+  m_log.apply(simulation);
+  m_nextEvent = 0;
+  m_finished = false;
+  applyPendingEvents(simulation);
+}
+
+// Aplica os eventos registrados no passo atual, na ordem original
+void SessionPlayer::applyPendingEvents(Simulation &simulation) {
+  auto const &events{m_log.events};
+  while (m_nextEvent < events.size() &&
+         events[m_nextEvent].tick <= simulation.getTick()) {
+    simulation.handleInput(events[m_nextEvent].input);
+    ++m_nextEvent;
+  }
+}
+
+void SessionPlayer::advance(Simulation &simulation, std::uint64_t maxSteps) {
+  for (std::uint64_t step = 0; step < maxSteps && !m_finished; ++step) {
+    applyPendingEvents(simulation);
+
+    // Com a bola fora de jogo o contador de passos não avança, então o
+    // lançamento seguinte foi registrado neste mesmo passo
+    if (!simulation.isStarted()) {
+      if (m_nextEvent < m_log.events.size())
+        throw std::runtime_error("Session replay diverged at tick " +
+                                 std::to_string(simulation.getTick()));
+      m_finished = true;
+      break;
+    }
+
+    if (simulation.getTick() >= m_log.endTick) {
+      m_finished = true;
+      break;
+    }
+    simulation.step();
+  }
+}
+
+void SessionPlayer::runToEnd(Simulation &simulation) {
+  while (!m_finished) {
+    advance(simulation, m_log.endTick + 1);
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef SESSIONLOG_HPP_
+#define SESSIONLOG_HPP_
+
+#include "gamedata.hpp"
+#include "simulation.hpp"
+#include "table.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Entrada do jogador aplicada à simulação no início do passo tick
+struct SessionEvent {
+  std::uint64_t tick{};
+  Simulation::Input input{};
+  // Instante do evento de teclado original, em milissegundos (SDL_GetTicks)
+  std::uint32_t timestamp{};
+};
+
+// Registro de uma sessão de jogo: mesa, semente, layout e todas as entradas.
+//
+// Como a física avança em passos fixos e as entradas são marcadas com o passo
+// em que foram aplicadas, reaplicá-las na mesma ordem reproduz a sessão bit a
+// bit. Em disco, cada evento ocupa tipicamente três bytes: o tipo da entrada
+// e as diferenças de passo e de tempo para o evento anterior, em varint.
+//
+// A mesa é gravada no formato compilado (Table::getData), de modo que a
+// sessão é reproduzida na mesa em que foi jogada mesmo depois de
+// assets/table.txt mudar. Uma mudança na física, que também faz a reprodução
+// divergir, exige uma nova versão do formato (logVersion).
+struct SessionLog {
+  Table table{Table::builtin()};
+  std::uint32_t seed{};
+  double tickRate{};
+  int multiBallCount{};
+  std::vector<Obstacle> obstacles;
+  std::vector<SessionEvent> events;
+  // Último passo simulado na sessão
+  std::uint64_t endTick{};
+
+  // Inicia um registro com a configuração atual da simulação
+  static SessionLog begin(Simulation const &simulation);
+
+  void record(Simulation const &simulation, Simulation::Input input,
+              std::uint32_t timestamp);
+  void finish(Simulation const &simulation);
+
+  // Prepara a simulação com a mesa, a semente e o layout registrados
+  void apply(Simulation &simulation) const;
+
+  [[nodiscard]] std::vector<std::uint8_t> encode() const;
+  static SessionLog decode(std::span<std::uint8_t const> data);
+
+  void save(std::string const &path) const;
+  static SessionLog load(std::string const &path);
+};
+
+// Reproduz um SessionLog, aplicando cada evento no passo em que foi
+// registrado. Os trechos com a bola fora de jogo não consomem passos e são
+// reproduzidos instantaneamente.
+class SessionPlayer {
+public:
+  explicit SessionPlayer(SessionLog log);
+
+  void start(Simulation &simulation);
+  // Simula até maxSteps passos, aplicando os eventos no caminho
+  void advance(Simulation &simulation, std::uint64_t maxSteps);
+  // Reproduz o restante da sessão sem limite de passos
+  void runToEnd(Simulation &simulation);
+
+  [[nodiscard]] bool isFinished() const noexcept { return m_finished; }
+  [[nodiscard]] SessionLog const &getLog() const noexcept { return m_log; }
+
+private:
+  SessionLog m_log;
+  std::size_t m_nextEvent{};
+  bool m_finished{};
+
+  void applyPendingEvents(Simulation &simulation);
+};
+
+#endif
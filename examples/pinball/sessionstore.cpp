@@ -0,0 +1,255 @@
+#include "sessionstore.hpp"
+#include "bytestream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> pageMagic{'P', 'B', 'S', 'P'};
+constexpr std::uint16_t storeVersion{1};
+
+struct PageHeader {
+  std::size_t count{};
+  SessionStore::Duration first{};
+  SessionStore::Duration last{};
+  std::string patient;
+};
+
+std::span<std::uint8_t const> asBytes(std::span<std::byte const> data) {
+  return {reinterpret_cast<std::uint8_t const *>(data.data()), data.size()};
+}
+
+void writeHeader(std::vector<std::uint8_t> &data, PageHeader const &header) {
+  ByteWriter writer{data};
+  for (auto const byte : pageMagic) {
+    writer.bytes(byte, 1);
+  }
+  writer.bytes(storeVersion, 2);
+  writer.bytes(header.count, 2);
+  writer.bytes(static_cast<std::uint64_t>(header.first.count()), 8);
+  writer.bytes(static_cast<std::uint64_t>(header.last.count()), 8);
+  // Nome do paciente completado com zeros
+  for (std::size_t i = 0; i < SessionStore::maxPatientLength; ++i) {
+    writer.bytes(i < header.patient.size()
+                     ? static_cast<std::uint8_t>(header.patient[i])
+                     : 0,
+                 1);
+  }
+}
+
+PageHeader readHeader(std::span<std::uint8_t const> data, std::size_t page) {
+  if (!std::equal(pageMagic.begin(), pageMagic.end(), data.begin()))
+    throw std::runtime_error("Invalid session store page " +
+                             std::to_string(page));
+  ByteReader reader{data.subspan(pageMagic.size()), "session store"};
+  if (reader.bytes(2) != storeVersion)
+    throw std::runtime_error("Unsupported session store version");
+
+  PageHeader header;
+  header.count = reader.bytes(2);
+  header.first = SessionStore::Duration{
+      static_cast<std::int64_t>(reader.bytes(8))};
+  header.last = SessionStore::Duration{
+      static_cast<std::int64_t>(reader.bytes(8))};
+  auto const name{reader.span(SessionStore::maxPatientLength)};
+  header.patient.assign(name.begin(), std::find(name.begin(), name.end(), 0));
+  if (header.count > SessionStore::recordsPerPage)
+    throw std::runtime_error("Invalid session store page " +
+                             std::to_string(page));
+  return header;
+}
+
+void writeRecord(std::vector<std::uint8_t> &data,
+                 SessionRecord const &record) {
+  ByteWriter writer{data};
+  writer.bytes(static_cast<std::uint64_t>(record.startTime.count()), 8);
+  writer.bytes(static_cast<std::uint64_t>(record.duration.count()), 4);
+  writer.bytes(record.attempts, 4);
+  writer.bytes(record.responses, 4);
+  writer.bytes(static_cast<std::uint64_t>(record.meanLatency.count()), 4);
+  writer.bytes(static_cast<std::uint64_t>(record.medianLatency.count()), 4);
+  writer.bytes(static_cast<std::uint64_t>(record.minLatency.count()), 4);
+  writer.bytes(static_cast<std::uint64_t>(record.maxLatency.count()), 4);
+}
+
+SessionRecord readRecord(ByteReader &reader) {
+  auto const microseconds{[&reader] {
+    return std::chrono::microseconds{reader.bytes(4)};
+  }};
+  SessionRecord record;
+  record.startTime =
+      std::chrono::milliseconds{static_cast<std::int64_t>(reader.bytes(8))};
+  record.duration = std::chrono::milliseconds{reader.bytes(4)};
+  record.attempts = static_cast<std::uint32_t>(reader.bytes(4));
+  record.responses = static_cast<std::uint32_t>(reader.bytes(4));
+  record.meanLatency = microseconds();
+  record.medianLatency = microseconds();
+  record.minLatency = microseconds();
+  record.maxLatency = microseconds();
+  return record;
+}
+
+} // namespace
+
+SessionStore::SessionStore(std::string path) : m_path{std::move(path)} {
+  open();
+}
+
+SessionStore::Duration SessionStore::now() {
+  return std::chrono::duration_cast<Duration>(
+      std::chrono::system_clock::now().time_since_epoch());
+}
+
+// Lê só os cabeçalhos: as páginas de registros são carregadas pelo sistema
+// operacional quando uma consulta as acessa
+void SessionStore::open() {
+  m_index.clear();
+  m_file.reset();
+  std::error_code error;
+  if (!std::filesystem::exists(m_path, error))
+    return;
+
+  m_file.emplace(m_path);
+  auto const data{asBytes(m_file->getData())};
+  // Uma página incompleta no fim (gravação interrompida) é ignorada, e a
+  // próxima gravação a sobrescreve
+  auto const pageCount{data.size() / pageSize};
+  m_index.reserve(pageCount);
+  for (std::size_t page = 0; page < pageCount; ++page) {
+    auto header{
+        readHeader(data.subspan(page * pageSize, pageHeaderSize), page)};
+    m_index.push_back({.patient = std::move(header.patient),
+                       .first = header.first,
+                       .last = header.last,
+                       .page = page,
+                       .count = header.count});
+  }
+  std::sort(m_index.begin(), m_index.end(),
+            [](PageEntry const &a, PageEntry const &b) {
+              return std::tie(a.patient, a.first, a.page) <
+                     std::tie(b.patient, b.first, b.page);
+            });
+}
+
+std::vector<SessionRecord> SessionStore::query(std::string_view patient,
+                                               Duration from,
+                                               Duration to) const {
+  std::vector<SessionRecord> records;
+  if (!m_file)
+    return records;
+
+  auto const data{asBytes(m_file->getData())};
+  auto entry{std::lower_bound(
+      m_index.begin(), m_index.end(), patient,
+      [](PageEntry const &a, std::string_view b) { return a.patient < b; })};
+  for (; entry != m_index.end() && entry->patient == patient; ++entry) {
+    // As páginas estão ordenadas pelo primeiro início, mas uma sessão pode
+    // ter sido gravada fora de ordem: só o fim do intervalo encerra a busca
+    if (entry->first >= to)
+      break;
+    if (entry->last < from)
+      continue;
+
+    ByteReader reader{
+        data.subspan(entry->page * pageSize + pageHeaderSize,
+                     entry->count * recordSize),
+        "session store"};
+    for (std::size_t i = 0; i < entry->count; ++i) {
+      auto const record{readRecord(reader)};
+      if (record.startTime >= from && record.startTime < to)
+        records.push_back(record);
+    }
+  }
+
+  std::stable_sort(records.begin(), records.end(),
+                   [](SessionRecord const &a, SessionRecord const &b) {
+                     return a.startTime < b.startTime;
+                   });
+  return records;
+}
+
+std::vector<std::string> SessionStore::getPatients() const {
+  std::vector<std::string> patients;
+  for (auto const &entry : m_index) {
+    if (patients.empty() || patients.back() != entry.patient)
+      patients.push_back(entry.patient);
+  }
+  return patients;
+}
+
+// O registro é gravado antes do cabeçalho que o conta: se a gravação for
+// interrompida entre os dois, a página continua válida, sem o registro
+void SessionStore::append(std::string_view patient,
+                          SessionRecord const &record) {
+  if (patient.empty() || patient.size() > maxPatientLength ||
+      patient.find('\0') != std::string_view::npos)
+    throw std::runtime_error("Invalid patient id: " + std::string{patient});
+
+  // Última página gravada do paciente
+  PageEntry const *last{};
+  for (auto const &entry : m_index) {
+    if (entry.patient == patient && (!last || entry.page > last->page))
+      last = &entry;
+  }
+
+  PageHeader header{.count = 1,
+                    .first = record.startTime,
+                    .last = record.startTime,
+                    .patient = std::string{patient}};
+  std::size_t page{};
+  std::size_t slot{};
+  if (last && last->count < recordsPerPage) {
+    header.count = last->count + 1;
+    header.first = std::min(last->first, record.startTime);
+    header.last = std::max(last->last, record.startTime);
+    page = last->page;
+    slot = last->count;
+  } else {
+    page = m_file ? m_file->getData().size() / pageSize : 0;
+  }
+  // Libera o mapeamento antes de alterar o arquivo
+  m_file.reset();
+
+  if (!std::filesystem::exists(m_path))
+    std::ofstream{m_path, std::ios::binary};
+  std::fstream file(m_path, std::ios::in | std::ios::out | std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Failed to open session store " + m_path);
+
+  std::vector<std::uint8_t> recordData;
+  writeRecord(recordData, record);
+  std::vector<std::uint8_t> headerData;
+  writeHeader(headerData, header);
+
+  auto const pageOffset{static_cast<std::streamoff>(page * pageSize)};
+  auto const write{[&file](std::vector<std::uint8_t> const &data) {
+    file.write(reinterpret_cast<char const *>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+  }};
+  if (slot == 0) {
+    // Página nova, gravada inteira de uma vez
+    auto pageData{headerData};
+    pageData.insert(pageData.end(), recordData.begin(), recordData.end());
+    pageData.resize(pageSize);
+    file.seekp(pageOffset);
+    write(pageData);
+  } else {
+    file.seekp(pageOffset + static_cast<std::streamoff>(
+                                pageHeaderSize + slot * recordSize));
+    write(recordData);
+    file.flush();
+    file.seekp(pageOffset);
+    write(headerData);
+  }
+  file.close();
+  if (!file)
+    throw std::runtime_error("Failed to write session store " + m_path);
+
+  open();
+}
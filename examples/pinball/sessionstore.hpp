@@ -0,0 +1,85 @@
+#ifndef SESSIONSTORE_HPP_
+#define SESSIONSTORE_HPP_
+
+#include "mappedfile.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Resumo de uma sessão de tempo de reação (ReactionTimer::Summary)
+struct SessionRecord {
+  // Início da sessão, desde a época de std::chrono::system_clock
+  std::chrono::milliseconds startTime{};
+  std::chrono::milliseconds duration{};
+  std::uint32_t attempts{};
+  std::uint32_t responses{};
+  std::chrono::microseconds meanLatency{};
+  std::chrono::microseconds medianLatency{};
+  std::chrono::microseconds minLatency{};
+  std::chrono::microseconds maxLatency{};
+};
+
+// Histórico de sessões de todos os pacientes, em um único arquivo.
+//
+// O arquivo é uma sequência de páginas de pageSize bytes, cada uma de um só
+// paciente: um cabeçalho (paciente, número de registros e o primeiro e o
+// último início de sessão da página) e até recordsPerPage registros de
+// tamanho fixo. Uma sessão nova ocupa o próximo registro livre da última
+// página do paciente, ou uma página nova no fim do arquivo; nada é reescrito
+// além do cabeçalho dessa página.
+//
+// Para leitura, o arquivo é mapeado em memória (MappedFile), e o índice
+// esparso, uma entrada por página ordenada por paciente e início, é montado
+// só com os cabeçalhos. Uma consulta lê apenas as páginas do paciente que
+// cruzam o intervalo pedido, de modo que o custo não cresce com o histórico
+// dos outros pacientes nem com o período fora do intervalo.
+class SessionStore {
+public:
+  using Duration = std::chrono::milliseconds;
+
+  static constexpr std::size_t pageSize{4096};
+  static constexpr std::size_t pageHeaderSize{64};
+  static constexpr std::size_t recordSize{36};
+  static constexpr std::size_t recordsPerPage{(pageSize - pageHeaderSize) /
+                                              recordSize};
+  static constexpr std::size_t maxPatientLength{40};
+
+  // Abre o arquivo; um arquivo inexistente é um histórico vazio
+  explicit SessionStore(std::string path);
+
+  // Sessões do paciente com início em [from, to), em ordem de início
+  [[nodiscard]] std::vector<SessionRecord>
+  query(std::string_view patient, Duration from, Duration to) const;
+  [[nodiscard]] std::vector<std::string> getPatients() const;
+  [[nodiscard]] std::size_t getPageCount() const noexcept {
+    return m_index.size();
+  }
+
+  // Grava a sessão no fim do histórico do paciente
+  void append(std::string_view patient, SessionRecord const &record);
+
+  // Instante atual na escala de SessionRecord::startTime
+  static Duration now();
+
+private:
+  struct PageEntry {
+    std::string patient;
+    Duration first{};
+    Duration last{};
+    std::size_t page{};
+    std::size_t count{};
+  };
+
+  std::string m_path;
+  std::optional<MappedFile> m_file;
+  // Ordenado por paciente e primeiro início
+  std::vector<PageEntry> m_index;
+
+  void open();
+};
+
+#endif
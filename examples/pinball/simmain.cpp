@@ -0,0 +1,301 @@
+// pinball_sim: executa a simulação do pinball sem janela, SDL ou OpenGL.
+//
+// Os passos fixos são simulados um após o outro, sem esperar pelo relógio,
+// e as entradas vêm de um roteiro em texto. Uso:
+//
+//   pinball_sim [--seconds S] [--seed N] [--obstacles N] [--tick-rate HZ]
+//               [--multiball N] [--script ARQUIVO] [--relaunch] [--trace N]
+//               [--record ARQUIVO] [--table MESA]
+//   pinball_sim --replay SESSAO...
+//
+// Cada linha do roteiro tem o instante, em segundos de jogo, e a ação:
+//
+//   # comentário
+//   0.0  launch
+//   1.25 left-down
+//   1.40 left-up
+//
+// Ações: launch, multiball, left-down, left-up, right-down, right-up. Sem
+// roteiro, a bola é lançada no instante zero.
+//
+// Com --replay, cada sessão gravada (pelo jogo ou por --record) é reproduzida
+// sem limite de velocidade, na mesa gravada nela, e uma linha de resumo é
+// impressa por sessão.
+//
+// Com --table, a simulação usa a mesa descrita no arquivo em vez da mesa
+// padrão (assets/table.txt).
+
+#include "sessionlog.hpp"
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fmt/core.h>
+#include <fstream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+struct ScriptEvent {
+  double time{};
+  Simulation::Input input{};
+};
+
+struct Options {
+  double seconds{60.0};
+  std::uint32_t seed{1};
+  int obstacles{6};
+  double tickRate{1000.0};
+  int multiBallCount{64};
+  std::string script;
+  bool relaunch{false};
+  std::uint64_t traceInterval{};
+  std::string record;
+  std::string table;
+  std::vector<std::string> replay;
+};
+
+template <typename T> T parseNumber(std::string_view text) {
+  T value{};
+  auto const *last{text.data() + text.size()};
+  auto const [ptr, ec]{std::from_chars(text.data(), last, value)};
+  if (ec != std::errc{} || ptr != last)
+    throw std::runtime_error(fmt::format("Invalid number: {}", text));
+  return value;
+}
+
+Simulation::Input parseAction(std::string_view action) {
+  using Input = Simulation::Input;
+  if (action == "launch")
+    return Input::Launch;
+  if (action == "multiball")
+    return Input::MultiBall;
+  if (action == "left-down")
+    return Input::LeftFlipperDown;
+  if (action == "left-up")
+    return Input::LeftFlipperUp;
+  if (action == "right-down")
+    return Input::RightFlipperDown;
+  if (action == "right-up")
+    return Input::RightFlipperUp;
+  throw std::runtime_error(fmt::format("Unknown action: {}", action));
+}
+
+std::vector<ScriptEvent> loadScript(std::string const &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw std::runtime_error(fmt::format("Failed to open {}", path));
+
+  std::vector<ScriptEvent> events;
+  std::string line;
+  for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+    if (auto const comment{line.find('#')}; comment != std::string::npos)
+      line.erase(comment);
+
+    std::istringstream stream(line);
+    std::string time;
+    std::string action;
+    if (!(stream >> time))
+      continue;
+    if (!(stream >> action))
+      throw std::runtime_error(
+          fmt::format("{}:{}: missing action", path, lineNumber));
+    events.push_back({parseNumber<double>(time), parseAction(action)});
+  }
+
+  // Eventos no mesmo instante mantêm a ordem do arquivo
+  std::stable_sort(
+      events.begin(), events.end(),
+      [](auto const &a, auto const &b) { return a.time < b.time; });
+  return events;
+}
+
+Options parseOptions(std::span<char *> args) {
+  Options options;
+  for (std::size_t i = 1; i < args.size(); ++i) {
+    std::string_view const arg{args[i]};
+    auto value = [&]() -> std::string_view {
+      if (i + 1 >= args.size())
+        throw std::runtime_error(fmt::format("Missing value for {}", arg));
+      return args[++i];
+    };
+
+    if (arg == "--seconds")
+      options.seconds = parseNumber<double>(value());
+    else if (arg == "--seed")
+      options.seed = parseNumber<std::uint32_t>(value());
+    else if (arg == "--obstacles")
+      options.obstacles = parseNumber<int>(value());
+    else if (arg == "--tick-rate")
+      options.tickRate = parseNumber<double>(value());
+    else if (arg == "--multiball")
+      options.multiBallCount = parseNumber<int>(value());
+    else if (arg == "--script")
+      options.script = value();
+    else if (arg == "--relaunch")
+      options.relaunch = true;
+    else if (arg == "--trace")
+      options.traceInterval = parseNumber<std::uint64_t>(value());
+    else if (arg == "--record")
+      options.record = value();
+    else if (arg == "--table")
+      options.table = value();
+    else if (arg == "--replay") {
+      // Os argumentos restantes são os arquivos das sessões
+      for (++i; i < args.size(); ++i) {
+        options.replay.emplace_back(args[i]);
+      }
+      if (options.replay.empty())
+        throw std::runtime_error("Missing value for --replay");
+    } else
+      throw std::runtime_error(fmt::format("Unknown option: {}", arg));
+  }
+  if (!options.replay.empty() && !options.table.empty())
+    throw std::runtime_error("--table cannot be used with --replay: sessions "
+                             "are replayed on their recorded table");
+  return options;
+}
+
+// Resumo do estado final (FNV-1a sobre as posições e velocidades), para
+// comparar execuções em testes de regressão da física
+std::uint64_t stateChecksum(Simulation const &simulation) {
+  std::uint64_t hash{14695981039346656037ULL};
+  auto mix = [&](float value) {
+    std::uint32_t bits{};
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int byte = 0; byte < 4; ++byte) {
+      hash ^= (bits >> (8 * byte)) & 0xFFU;
+      hash *= 1099511628211ULL;
+    }
+  };
+
+  auto const &ball{simulation.getBall()};
+  mix(ball.position.x);
+  mix(ball.position.y);
+  mix(ball.velocity.x);
+  mix(ball.velocity.y);
+  auto const &balls{simulation.getMultiBalls()};
+  for (std::size_t i = 0; i < balls.size(); ++i) {
+    mix(balls.getPosition(i).x);
+    mix(balls.getPosition(i).y);
+  }
+  return hash;
+}
+
+// Mesa de --table, ou a mesa padrão
+Table loadTable(Options const &options) {
+  return options.table.empty() ? Table::builtin() : Table::load(options.table);
+}
+
+// Reproduz as sessões gravadas, uma linha por sessão
+void replaySessions(std::vector<std::string> const &paths) {
+  fmt::print("session seed events ticks drains checksum seconds\n");
+  for (auto const &path : paths) {
+    auto const start{std::chrono::steady_clock::now()};
+
+    SessionPlayer player{SessionLog::load(path)};
+    Simulation simulation;
+    player.start(simulation);
+    player.runToEnd(simulation);
+
+    std::chrono::duration<double> const wallTime{
+        std::chrono::steady_clock::now() - start};
+    auto const &log{player.getLog()};
+    fmt::print("{} {} {} {} {} {:016x} {:.3f}\n", path, log.seed,
+               log.events.size(), simulation.getTick(),
+               simulation.getDrainCount(), stateChecksum(simulation),
+               wallTime.count());
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    auto const options{
+        parseOptions(std::span{argv, static_cast<std::size_t>(argc)})};
+
+    if (!options.replay.empty()) {
+      replaySessions(options.replay);
+      return 0;
+    }
+
+    std::vector<ScriptEvent> events{{0.0, Simulation::Input::Launch}};
+    if (!options.script.empty())
+      events = loadScript(options.script);
+
+    Simulation simulation;
+    simulation.setTable(loadTable(options));
+    simulation.getTimestep().setTickRate(options.tickRate);
+    simulation.setMultiBallCount(options.multiBallCount);
+    simulation.generateObstacles(options.seed, options.obstacles);
+
+    auto const tickRate{simulation.getTimestep().getTickRate()};
+    auto const totalTicks{
+        static_cast<std::uint64_t>(std::max(options.seconds, 0.0) * tickRate)};
+
+    auto session{SessionLog::begin(simulation)};
+    auto const start{std::chrono::steady_clock::now()};
+
+    // O relógio de jogo avança um passo por iteração, mesmo com a bola fora
+    // de jogo, para que os instantes do roteiro sejam respeitados
+    std::size_t nextEvent{0};
+    for (std::uint64_t frame = 0; frame < totalTicks; ++frame) {
+      auto const time{static_cast<double>(frame) / tickRate};
+      auto const apply = [&](Simulation::Input input) {
+        session.record(simulation, input,
+                       static_cast<std::uint32_t>(time * 1000.0));
+        simulation.handleInput(input);
+      };
+      while (nextEvent < events.size() && events[nextEvent].time <= time) {
+        apply(events[nextEvent].input);
+        ++nextEvent;
+      }
+      if (options.relaunch && !simulation.isStarted())
+        apply(Simulation::Input::Launch);
+
+      simulation.step();
+
+      if (options.traceInterval > 0 && frame % options.traceInterval == 0) {
+        auto const &ball{simulation.getBall()};
+        fmt::print("{:.3f} {:.6f} {:.6f} {:.6f} {:.6f}\n", time,
+                   ball.position.x, ball.position.y, ball.velocity.x,
+                   ball.velocity.y);
+      }
+    }
+
+    std::chrono::duration<double> const wallTime{
+        std::chrono::steady_clock::now() - start};
+    if (!options.record.empty()) {
+      session.finish(simulation);
+      session.save(options.record);
+    }
+    auto const gameTime{static_cast<double>(totalTicks) / tickRate};
+    auto const &ball{simulation.getBall()};
+
+    fmt::print("seed:           {}\n", options.seed);
+    fmt::print("game time:      {:.3f} s ({} ticks)\n", gameTime, totalTicks);
+    fmt::print("physics steps:  {}\n", simulation.getTick());
+    fmt::print("wall time:      {:.3f} s ({:.0f}x real time)\n",
+               wallTime.count(),
+               wallTime.count() > 0.0 ? gameTime / wallTime.count() : 0.0);
+    fmt::print("drains:         {}\n", simulation.getDrainCount());
+    fmt::print("ball:           pos ({:.6f}, {:.6f}) vel ({:.6f}, {:.6f})\n",
+               ball.position.x, ball.position.y, ball.velocity.x,
+               ball.velocity.y);
+    fmt::print("multi-balls:    {}\n", simulation.getMultiBalls().size());
+    fmt::print("checksum:       {:016x}\n", stateChecksum(simulation));
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
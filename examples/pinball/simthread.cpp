@@ -0,0 +1,127 @@
+#include "simthread.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+void SimulationSnapshot::capture(Simulation const &simulation) {
+  tick = simulation.getTick();
+  started = simulation.isStarted();
+  ball = simulation.getBall();
+  leftFlipper = simulation.getLeftFlipper();
+  rightFlipper = simulation.getRightFlipper();
+  if (layoutVersion != simulation.getLayoutVersion()) {
+    layoutVersion = simulation.getLayoutVersion();
+    obstacles.assign(simulation.getObstacles().begin(),
+                     simulation.getObstacles().end());
+  }
+
+  auto const &balls{simulation.getMultiBalls()};
+  multiBallPositions.resize(balls.size());
+  multiBallPreviousPositions.resize(balls.size());
+  multiBallRadii.resize(balls.size());
+  for (std::size_t i = 0; i < balls.size(); ++i) {
+    multiBallPositions[i] = balls.getPosition(i);
+    multiBallPreviousPositions[i] = balls.getPreviousPosition(i);
+    multiBallRadii[i] = balls.getRadius(i);
+  }
+
+  alpha = simulation.getTimestep().getAlpha();
+  tickRate = simulation.getTimestep().getTickRate();
+  time = Clock::now();
+}
+
+float SimulationSnapshot::interpolation(Clock::time_point now) const {
+  auto const elapsed{std::chrono::duration<double>(now - time).count()};
+  return static_cast<float>(
+      std::clamp(alpha + std::max(elapsed, 0.0) * tickRate, 0.0, 1.0));
+}
+
+SimulationThread::SimulationThread(Simulation &simulation, Advance advance,
+                                   ApplyInput applyInput)
+    : m_simulation{simulation}, m_advance{std::move(advance)},
+      m_applyInput{std::move(applyInput)} {}
+
+SimulationThread::~SimulationThread() { stop(); }
+
+void SimulationThread::start() {
+  if (m_running.exchange(true))
+    return;
+
+  // O primeiro snapshot já está disponível quando start retorna
+  publish();
+  m_thread = std::thread([this] { run(); });
+}
+
+void SimulationThread::stop() {
+  m_running.store(false, std::memory_order_release);
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+bool SimulationThread::pushInput(Simulation::Input input,
+                                 std::uint32_t timestamp,
+                                 SimulationSnapshot::Clock::time_point time) {
+  return m_inputs.push({.input = input, .timestamp = timestamp, .time = time});
+}
+
+SimulationSnapshot const &SimulationThread::latest() {
+  m_snapshots.update();
+  return m_snapshots.front();
+}
+
+std::optional<CollisionEvent> SimulationThread::popCollisionEvent() {
+  return m_collisionEvents.pop();
+}
+
+void SimulationThread::publish() {
+  // Com a fila cheia, os eventos restantes do despertar são descartados
+  for (auto const &event : m_simulation.getCollisionEvents()) {
+    if (!m_collisionEvents.push(event))
+      break;
+  }
+  m_simulation.clearCollisionEvents();
+
+  m_snapshots.back().capture(m_simulation);
+  m_snapshots.publish();
+}
+
+// A cada despertar: aplica as entradas pendentes, cada uma depois de avançar
+// a simulação até o instante em que ocorreu, avança a simulação pelo restante
+// do tempo real decorrido (o FixedTimestep converte em passos) e publica o
+// estado e as colisões. Assim, uma entrada é aplicada no passo em que ocorreu,
+// e não no passo do despertar em que chegou. Os despertares seguem uma grade
+// de período fixo; se a thread se atrasar, a grade recomeça do instante atual
+// em vez de tentar recuperar os despertares perdidos, pois o tempo perdido já
+// é simulado no despertar seguinte
+void SimulationThread::run() {
+  using Clock = std::chrono::steady_clock;
+  auto const period{std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(
+          1.0 / m_simulation.getTimestep().getTickRate()))};
+
+  auto previous{Clock::now()};
+  auto const advanceTo{[this, &previous](Clock::time_point time) {
+    m_advance(m_simulation,
+              std::chrono::duration<double>(time - previous).count());
+    previous = time;
+  }};
+
+  auto wakeUp{previous + period};
+  while (m_running.load(std::memory_order_acquire)) {
+    while (auto const event{m_inputs.pop()}) {
+      if (event->time > previous)
+        advanceTo(event->time);
+      m_applyInput(m_simulation, event->input, event->timestamp, event->time);
+    }
+
+    auto const now{Clock::now()};
+    advanceTo(now);
+    publish();
+
+    if (wakeUp < now)
+      wakeUp = now;
+    std::this_thread::sleep_until(wakeUp);
+    wakeUp += period;
+  }
+}
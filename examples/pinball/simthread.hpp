@@ -0,0 +1,114 @@
+#ifndef SIMTHREAD_HPP_
+#define SIMTHREAD_HPP_
+
+#include "gamedata.hpp"
+#include "simulation.hpp"
+#include "spscqueue.hpp"
+#include "triplebuffer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Estado da simulação necessário para desenhar um frame.
+//
+// Guarda as posições do início e do fim do último passo (previousPosition da
+// bola, previousAngle dos flippers e multiBallPreviousPositions), de modo que
+// o frame possa ser desenhado entre os dois passos, na fração do passo já
+// decorrida, em vez de saltar de um passo para o outro
+struct SimulationSnapshot {
+  using Clock = std::chrono::steady_clock;
+
+  std::uint64_t tick{};
+  bool started{};
+  Ball ball;
+  Flipper leftFlipper;
+  Flipper rightFlipper;
+  // Copiados só quando o layout muda (Simulation::getLayoutVersion)
+  std::uint64_t layoutVersion{};
+  std::vector<Obstacle> obstacles;
+  std::vector<glm::vec2> multiBallPositions;
+  std::vector<glm::vec2> multiBallPreviousPositions;
+  std::vector<float> multiBallRadii;
+
+  // Fração do próximo passo acumulada pelo FixedTimestep na captura, e
+  // instante da captura
+  float alpha{};
+  double tickRate{};
+  Clock::time_point time{};
+
+  // Copia o estado da simulação, reaproveitando a memória dos vetores
+  void capture(Simulation const &simulation);
+  // Fração do passo em que o frame deve ser desenhado no instante now: alpha
+  // mais o tempo decorrido desde a captura, limitada a 1 (um snapshot nunca é
+  // extrapolado além do último passo)
+  [[nodiscard]] float interpolation(Clock::time_point now) const;
+};
+
+// Executa a simulação em uma thread própria, em ritmo fixo (um despertar por
+// passo de física), independente da renderização.
+//
+// A thread da janela envia as entradas do jogador por uma fila sem travas e
+// lê o estado por snapshots publicados em um buffer triplo: nenhuma das duas
+// threads espera pela outra, de modo que uma troca de buffers lenta ou um
+// frame longo da interface não atrasa a física. Enquanto a thread estiver
+// rodando, a Simulation pertence a ela e não deve ser acessada de fora.
+class SimulationThread {
+public:
+  // Avança a simulação pelo tempo real decorrido, em segundos
+  using Advance = std::function<void(Simulation &, double)>;
+  // Aplica uma entrada do jogador, com o instante em que ela ocorreu, na
+  // thread da simulação
+  using ApplyInput =
+      std::function<void(Simulation &, Simulation::Input, std::uint32_t,
+                         SimulationSnapshot::Clock::time_point)>;
+
+  SimulationThread(Simulation &simulation, Advance advance,
+                   ApplyInput applyInput);
+  ~SimulationThread();
+
+  SimulationThread(SimulationThread const &) = delete;
+  SimulationThread &operator=(SimulationThread const &) = delete;
+
+  void start();
+  void stop();
+
+  // Thread da janela: envia uma entrada ocorrida no instante time, aplicada
+  // no próximo despertar da simulação depois de avançá-la até time. Retorna
+  // false se a fila estiver cheia
+  bool pushInput(Simulation::Input input, std::uint32_t timestamp,
+                 SimulationSnapshot::Clock::time_point time);
+  // Thread da janela: snapshot mais recente publicado
+  [[nodiscard]] SimulationSnapshot const &latest();
+  // Thread da janela: próxima colisão da bola, se a simulação registra as
+  // colisões (Simulation::setCollisionEventsEnabled). Ao contrário dos
+  // snapshots, nenhum evento é descartado, a menos que a fila encha
+  [[nodiscard]] std::optional<CollisionEvent> popCollisionEvent();
+
+private:
+  struct InputEvent {
+    Simulation::Input input{};
+    std::uint32_t timestamp{};
+    SimulationSnapshot::Clock::time_point time{};
+  };
+
+  Simulation &m_simulation;
+  Advance m_advance;
+  ApplyInput m_applyInput;
+
+  SpscQueue<InputEvent, 256> m_inputs;
+  SpscQueue<CollisionEvent, 1024> m_collisionEvents;
+  TripleBuffer<SimulationSnapshot> m_snapshots;
+
+  std::atomic<bool> m_running{false};
+  std::thread m_thread;
+
+  void run();
+  void publish();
+};
+
+#endif
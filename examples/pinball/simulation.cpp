@@ -0,0 +1,585 @@
+#include "simulation.hpp"
+#include "collision.hpp"
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vector_relational.hpp>
+#include <optional>
+#include <random>
+#include <utility>
+
+namespace {
+// Velocidade normal abaixo da qual o contato com um flipper não quica: a bola
+// apoiada ou rolando sobre ele não vibra a cada passo
+constexpr float restingSpeed{0.05f};
+// Intervalo, em segundos, durante o qual um novo toque no flipper continua o
+// contato anterior: a bola apoiada pode se separar por alguns passos
+constexpr double contactMemory{0.02};
+
+// O flipper direito aponta para -x e gira no sentido oposto
+RotatingCapsule flipperCapsule(Flipper const &flipper, bool isLeft,
+                               float angle) {
+  return {.pivot = flipper.position,
+          .length = flipper.length,
+          .radius = flipper.radius,
+          .angle = isLeft ? angle : static_cast<float>(M_PI) - angle,
+          .angularVelocity =
+              isLeft ? flipper.angularVelocity : -flipper.angularVelocity};
+}
+} // namespace
+
+Simulation::Simulation() {
+  // Física em passo fixo de 1 kHz, com no máximo 0,1 s simulado por frame
+  m_timestep.setTickRate(1000.0);
+  m_timestep.setMaxSubsteps(100);
+
+  m_launchVelocity = m_table.getSettings().launchVelocity;
+  setupBall();
+  setupFlippers();
+}
+
+void Simulation::setTable(Table table) {
+  m_table = std::move(table);
+  ++m_layoutVersion;
+  m_launchVelocity = m_table.getSettings().launchVelocity;
+  reset();
+}
+
+void Simulation::reset() {
+  setupBall();
+  setupFlippers();
+  m_multiBalls.clear();
+  m_started = false;
+  m_timestep.reset();
+  m_tick = 0;
+  m_drainCount = 0;
+}
+
+void Simulation::generateObstacles(std::uint32_t seed, int count) {
+  generateObstacles(seed, LayoutSettings{.count = count});
+}
+
+void Simulation::generateObstacles(std::uint32_t seed,
+                                   LayoutSettings const &settings) {
+  std::mt19937 gen(seed);
+
+  // Distribuições para posições e tamanhos aleatórios dos obstáculos
+  std::uniform_real_distribution<float> distPosX(settings.positionX.x,
+                                                 settings.positionX.y);
+  std::uniform_real_distribution<float> distPosY(settings.positionY.x,
+                                                 settings.positionY.y);
+  std::uniform_real_distribution<float> distRadius(settings.radius.x,
+                                                   settings.radius.y);
+
+  // Criação dos obstáculos com posições e raios aleatórios
+  std::vector<Obstacle> obstacles;
+  obstacles.reserve(static_cast<std::size_t>(std::max(settings.count, 0)));
+  for (int i = 0; i < settings.count; ++i) {
+    glm::vec2 randomPosition(distPosX(gen), distPosY(gen));
+    float randomRadius = distRadius(gen);
+    obstacles.push_back({randomPosition, randomRadius});
+  }
+  setObstacles(std::move(obstacles), seed);
+}
+
+void Simulation::setObstacles(std::vector<Obstacle> obstacles,
+                              std::uint32_t seed) {
+  m_obstacles = std::move(obstacles);
+  m_seed = seed;
+  ++m_layoutVersion;
+  rebuildObstacleGrid();
+}
+
+void Simulation::handleInput(Input input) {
+  switch (input) {
+  case Input::Launch:
+    launch();
+    break;
+  case Input::MultiBall:
+    startMultiBall();
+    break;
+  case Input::LeftFlipperDown:
+    m_leftFlipper.targetAngle = m_leftFlipper.activeAngle;
+    break;
+  case Input::LeftFlipperUp:
+    m_leftFlipper.targetAngle = m_leftFlipper.restAngle;
+    break;
+  case Input::RightFlipperDown:
+    m_rightFlipper.targetAngle = m_rightFlipper.activeAngle;
+    break;
+  case Input::RightFlipperUp:
+    m_rightFlipper.targetAngle = m_rightFlipper.restAngle;
+    break;
+  }
+}
+
+int Simulation::update(double frameTime) {
+  if (!m_started)
+    return 0;
+
+  // Consome o tempo do frame em passos fixos de física
+  auto const steps{m_timestep.advance(frameTime)};
+  int simulated{0};
+  for (; simulated < steps && m_started; ++simulated) {
+    step();
+  }
+
+  // A bola caiu durante um dos passos: descarta o tempo acumulado
+  if (!m_started)
+    m_timestep.reset();
+
+  return simulated;
+}
+
+void Simulation::step() {
+  if (!m_started)
+    return;
+
+  stepPhysics(m_timestep.getStep());
+  ++m_tick;
+}
+
+// Lança a bola, se ela ainda não estiver em jogo
+void Simulation::launch() {
+  if (m_started)
+    return;
+
+  m_started = true;
+  m_timestep.reset();
+  m_ball.velocity = m_launchVelocity;
+}
+
+// Coloca a bola na posição de lançamento da mesa
+void Simulation::setupBall() {
+  auto const &settings{m_table.getSettings()};
+  m_ball.position = settings.ballPosition;
+  m_ball.previousPosition = m_ball.position;
+  m_ball.velocity = {0.0f, 0.0f};
+  m_ball.radius = settings.ballRadius / GAME_SCALE;
+}
+
+// Coloca os flippers da mesa na posição de repouso
+void Simulation::setupFlippers() {
+  auto const setup = [](Flipper &flipper, TableFlipper const &description) {
+    flipper = {.position = description.pivot,
+               .currentAngle = description.restAngle,
+               .previousAngle = description.restAngle,
+               .targetAngle = description.restAngle,
+               .length = description.length,
+               .radius = description.radius,
+               .restAngle = description.restAngle,
+               .activeAngle = description.activeAngle,
+               .restitution = description.restitution,
+               .friction = description.friction};
+  };
+  setup(m_leftFlipper, m_table.getLeftFlipper());
+  setup(m_rightFlipper, m_table.getRightFlipper());
+  m_leftFlipperContact = {};
+  m_rightFlipperContact = {};
+}
+
+// Avança a simulação em um passo de tamanho fixo
+void Simulation::stepPhysics(float deltaTime) {
+  // Configurações de velocidade angular dos flippers
+  float maxAngularSpeed = 5.0f;
+  float maxAngularVelocity = 5.0f;
+
+  // Lambda function para atualizar os ângulos dos flippers
+  auto updateFlipperAngle = [&](Flipper &flipper) {
+    float previousAngle = flipper.currentAngle;
+    flipper.previousAngle = previousAngle;
+    float angleDifference = flipper.targetAngle - flipper.currentAngle;
+    float angleStep = maxAngularSpeed * deltaTime;
+
+    // Atualiza o ângulo atual
+    if (std::abs(angleDifference) < angleStep) {
+      flipper.currentAngle = flipper.targetAngle;
+    } else {
+      flipper.currentAngle += (angleDifference > 0 ? angleStep : -angleStep);
+    }
+
+    // Calcula e limita a velocidade angular
+    flipper.angularVelocity =
+        (flipper.currentAngle - previousAngle) / deltaTime;
+    flipper.angularVelocity = std::clamp(
+        flipper.angularVelocity, -maxAngularVelocity, maxAngularVelocity);
+  };
+
+  // Atualiza ambos os flippers
+  updateFlipperAngle(m_leftFlipper);
+  updateFlipperAngle(m_rightFlipper);
+
+  // Posição de partida do passo, usada para interpolar a renderização
+  m_ball.previousPosition = m_ball.position;
+
+  // Aplica gravidade à bola
+  m_ball.velocity.y -= 0.8f * deltaTime;
+
+  // Verifica se a velocidade da bola é válida
+  if (glm::any(glm::isnan(m_ball.velocity)) ||
+      glm::any(glm::isinf(m_ball.velocity))) {
+    m_ball.velocity = glm::vec2(0.0f);
+  }
+
+  // Move a bola resolvendo os contatos dentro do passo e verifica colisões
+  moveBall(deltaTime);
+  checkCollisions();
+
+  if (!m_multiBalls.empty())
+    stepMultiBalls(deltaTime);
+}
+
+// Avança as bolas do modo multibola. Cada etapa percorre todas as bolas de
+// uma vez sobre os arrays da BallSet, em vez de bola a bola
+void Simulation::stepMultiBalls(float deltaTime) {
+  m_multiBalls.applyGravity(0.8f, deltaTime);
+  m_multiBalls.integrate(deltaTime);
+
+  m_multiBalls.collideBalls();
+  m_multiBalls.collideObstacles(m_obstacles, m_obstacleGrid);
+  m_multiBalls.collideFlipper(m_leftFlipper, true);
+  m_multiBalls.collideFlipper(m_rightFlipper, false);
+  m_multiBalls.collideSegments(m_table.getSegments());
+  m_multiBalls.collideArcs(m_table.getArcs());
+  m_multiBalls.collideBumpers(m_table.getBumpers());
+
+  m_multiBalls.removeDrained(m_table.getSettings().drainHeight);
+}
+
+// Inicia uma rodada multibola com m_multiBallCount bolas distribuídas em
+// grade na parte superior da mesa
+void Simulation::startMultiBall() {
+  launch();
+
+  auto const count{std::max(m_multiBallCount, 0)};
+  if (count == 0)
+    return;
+
+  // Reduz o raio quando há muitas bolas, para que caibam na área de saída
+  glm::vec2 const areaMin{WALL_LEFT + 0.2f, 0.2f};
+  glm::vec2 const areaMax{WALL_RIGHT - 0.2f, WALL_TOP - 0.1f};
+  glm::vec2 const area{areaMax - areaMin};
+  auto const spacing{std::sqrt(area.x * area.y / static_cast<float>(count))};
+  auto const radius{std::min(m_ball.radius * GAME_SCALE, 0.4f * spacing)};
+  auto const columns{std::max(static_cast<int>(area.x / spacing), 1)};
+
+  for (int i = 0; i < count; ++i) {
+    glm::vec2 const cell{i % columns, i / columns};
+    glm::vec2 const position{areaMin.x + (cell.x + 0.5f) * spacing,
+                             areaMax.y - (cell.y + 0.5f) * spacing};
+    glm::vec2 const velocity{static_cast<float>(i % 7 - 3) * 0.2f, 0.0f};
+    m_multiBalls.add(position, velocity, radius);
+  }
+}
+
+// Move a bola pelo passo inteiro com detecção contínua de colisões: avança
+// até o primeiro contato, resolve a colisão e continua com o tempo restante
+void Simulation::moveBall(float deltaTime) {
+  // Limita o número de contatos por passo (bola presa entre dois objetos)
+  int const maxContactsPerStep{8};
+
+  float elapsed{0.0f};
+  for (int i = 0; i < maxContactsPerStep && elapsed < deltaTime; ++i) {
+    Contact contact{.time = deltaTime - elapsed};
+    checkCollisionWithFlippers(contact, elapsed);
+    checkCollisionWithObstacles(contact);
+    checkCollisionWithTable(contact);
+
+    m_ball.position += m_ball.velocity * contact.time;
+    elapsed += contact.time;
+
+    if (!contact.hit)
+      break;
+    resolveContact(contact);
+  }
+}
+
+// Aplica a resposta de uma colisão à velocidade da bola: a velocidade
+// relativa à superfície é refletida com a restituição do contato, e o atrito
+// reduz a componente tangencial
+void Simulation::resolveContact(Contact const &contact) {
+  glm::vec2 relativeVelocity = m_ball.velocity - contact.surfaceVelocity;
+  float normalSpeed = glm::dot(relativeVelocity, contact.normal);
+  if (normalSpeed >= 0.0f)
+    return;
+
+  // A bola apoiada em um flipper toca nele a cada passo; só o primeiro toque
+  // e os impactos de verdade (o flipper acionado sob a bola) geram eventos
+  float restitution = contact.restitution;
+  bool reported = true;
+  if (contact.flipperContact != nullptr) {
+    bool const newContact{touchFlipper(*contact.flipperContact)};
+    if (-normalSpeed < restingSpeed) {
+      restitution = 0.0f;
+      reported = newContact;
+    }
+  }
+
+  if (m_collisionEventsEnabled && reported) {
+    m_collisionEvents.push_back({.kind = contact.kind,
+                                 .tick = m_tick,
+                                 .position = m_ball.position,
+                                 .impactSpeed = -normalSpeed});
+  }
+
+  glm::vec2 newVelocity = Collision::resolveVelocity(
+      m_ball.velocity, contact.normal, contact.surfaceVelocity, restitution,
+      contact.friction);
+
+  if (!glm::any(glm::isnan(newVelocity)) &&
+      !glm::any(glm::isinf(newVelocity))) {
+    m_ball.velocity = newVelocity;
+  }
+}
+
+// Registra um toque no flipper neste passo; retorna se é um contato novo, ou
+// seja, se a bola não tocava o flipper nos últimos contactMemory segundos
+bool Simulation::touchFlipper(FlipperContact &contact) noexcept {
+  auto const memoryTicks{std::max(
+      static_cast<std::uint64_t>(contactMemory * m_timestep.getTickRate()),
+      std::uint64_t{1})};
+  bool const persistent{contact.active &&
+                        contact.lastTick + memoryTicks >= m_tick};
+  contact = {.active = true, .lastTick = m_tick};
+  return !persistent;
+}
+
+// Procura o primeiro contato entre a bola e os flippers em rotação. O tempo
+// elapsed é o instante dentro do passo atual em que a varredura começa.
+//
+// A velocidade do ponto de contato vem da velocidade angular do flipper e da
+// distância ao pivô, de modo que a bola sai mais rápida quando atingida perto
+// da ponta. Cada flipper gera no máximo um contato por passo: após a resposta,
+// a bola já não se aproxima dele, e uma sobreposição residual é corrigida por
+// resolveFlipperOverlaps ao final do passo, sem gastar iterações de moveBall
+// com a bola presa entre o flipper e outro elemento.
+void Simulation::checkCollisionWithFlippers(Contact &contact, float elapsed) {
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+
+  auto checkBallFlipperCollision = [&](Flipper const &flipper, bool isLeft,
+                                       FlipperContact &flipperContact) {
+    if (flipperContact.active && flipperContact.lastTick == m_tick)
+      return;
+
+    float angle = flipper.previousAngle + flipper.angularVelocity * elapsed;
+    RotatingCapsule capsule = flipperCapsule(flipper, isLeft, angle);
+
+    auto const time{Collision::sweepCircleRotatingCapsule(
+        m_ball.position, m_ball.velocity, scaledBallRadius, capsule,
+        contact.time)};
+    if (!time || (contact.hit && *time >= contact.time))
+      return;
+
+    // Normal e velocidade do ponto de contato na superfície do flipper
+    glm::vec2 ballPosition = m_ball.position + m_ball.velocity * *time;
+    glm::vec2 closest =
+        Collision::closestPointOnCapsule(capsule, ballPosition, *time);
+    glm::vec2 offset = ballPosition - closest;
+    if (glm::length(offset) <= 0.0f)
+      return;
+
+    contact = {.time = *time,
+               .normal = glm::normalize(offset),
+               .surfaceVelocity =
+                   Collision::capsuleSurfaceVelocity(capsule, closest),
+               .restitution = flipper.restitution,
+               .friction = flipper.friction,
+               .hit = true,
+               .kind = CollisionEvent::Kind::Flipper,
+               .flipperContact = &flipperContact};
+  };
+
+  // Verifica colisões com ambos os flippers
+  checkBallFlipperCollision(m_leftFlipper, true, m_leftFlipperContact);
+  checkBallFlipperCollision(m_rightFlipper, false, m_rightFlipperContact);
+}
+
+// Procura o primeiro contato entre a bola e os obstáculos
+void Simulation::checkCollisionWithObstacles(Contact &contact) {
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+
+  // Fase ampla: apenas os obstáculos das células tocadas pela caixa que
+  // envolve a trajetória da bola no restante do passo
+  glm::vec2 endPosition = m_ball.position + m_ball.velocity * contact.time;
+  m_obstacleCandidates.clear();
+  m_obstacleGrid.query(glm::min(m_ball.position, endPosition) -
+                           scaledBallRadius,
+                       glm::max(m_ball.position, endPosition) +
+                           scaledBallRadius,
+                       m_obstacleCandidates);
+
+  for (auto const index : m_obstacleCandidates) {
+    auto const &obstacle{m_obstacles[index]};
+
+    // Rejeição pela distância ao quadrado antes de qualquer raiz quadrada
+    auto const time{Collision::sweepCircleCircle(
+        m_ball.position, m_ball.velocity, scaledBallRadius,
+        obstacle.position, obstacle.collisionRadius(), contact.time)};
+    if (!time || (contact.hit && *time >= contact.time))
+      continue;
+
+    // A bola é refletida pelo vetor normal no ponto de contato
+    glm::vec2 offset =
+        m_ball.position + m_ball.velocity * *time - obstacle.position;
+    if (glm::length(offset) <= 0.0f)
+      continue;
+
+    contact = {.time = *time,
+               .normal = glm::normalize(offset),
+               .restitution = 1.0f,
+               .hit = true,
+               .kind = CollisionEvent::Kind::Obstacle};
+  }
+}
+
+// Procura o primeiro contato entre a bola e os elementos da mesa. Todos são
+// tratados da mesma forma: a varredura dá o instante do contato, e a normal
+// vem do ponto mais próximo do elemento nesse instante
+void Simulation::checkCollisionWithTable(Contact &contact) {
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+
+  auto consider = [&](std::optional<float> time, auto closestPoint,
+                      float restitution, CollisionEvent::Kind kind) {
+    if (!time || (contact.hit && *time >= contact.time))
+      return;
+
+    glm::vec2 ballPosition = m_ball.position + m_ball.velocity * *time;
+    glm::vec2 offset = ballPosition - closestPoint(ballPosition);
+    if (glm::length(offset) <= 0.0f)
+      return;
+
+    contact = {.time = *time,
+               .normal = glm::normalize(offset),
+               .restitution = restitution,
+               .hit = true,
+               .kind = kind};
+  };
+
+  for (auto const &segment : m_table.getSegments()) {
+    consider(Collision::sweepCircleSegment(m_ball.position, m_ball.velocity,
+                                           scaledBallRadius, segment.a,
+                                           segment.b, contact.time),
+             [&](glm::vec2 point) {
+               return Collision::closestPointOnSegment(point, segment.a,
+                                                       segment.b);
+             },
+             segment.restitution, CollisionEvent::Kind::Wall);
+  }
+
+  for (auto const &arc : m_table.getArcs()) {
+    consider(Collision::sweepCircleArc(m_ball.position, m_ball.velocity,
+                                       scaledBallRadius, arc.center,
+                                       arc.radius, arc.startAngle,
+                                       arc.endAngle, contact.time),
+             [&](glm::vec2 point) {
+               return Collision::closestPointOnArc(point, arc.center,
+                                                   arc.radius, arc.startAngle,
+                                                   arc.endAngle);
+             },
+             arc.restitution, CollisionEvent::Kind::Wall);
+  }
+
+  for (auto const &bumper : m_table.getBumpers()) {
+    consider(Collision::sweepCircleCircle(m_ball.position, m_ball.velocity,
+                                          scaledBallRadius, bumper.position,
+                                          bumper.radius, contact.time),
+             [&](glm::vec2 /*point*/) { return bumper.position; },
+             bumper.restitution, CollisionEvent::Kind::Obstacle);
+  }
+}
+
+// Reconstrói a fase ampla; deve ser chamada sempre que o layout mudar
+void Simulation::rebuildObstacleGrid() {
+  m_obstacleGrid.build(m_obstacles);
+  m_obstacleCandidates.reserve(m_obstacles.size());
+}
+
+// Sistema de colisões discretas, aplicado ao final de cada passo
+void Simulation::checkCollisions() {
+  resolveFlipperOverlaps();
+  resolveTableOverlaps();
+
+  // Reset da bola se ela cair abaixo da mesa
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+  if ((m_ball.position.y - scaledBallRadius) <
+      m_table.getSettings().drainHeight) {
+    setupBall();
+    m_multiBalls.clear();
+    m_started = false;
+    ++m_drainCount;
+  }
+}
+
+// Correção de posição dos flippers: o avanço conservativo para a uma
+// distância contactTolerance da superfície, e a bola apoiada em um flipper em
+// movimento pode terminar o passo levemente dentro dele. A bola é levada de
+// volta à superfície e perde a velocidade de aproximação, sem quicar; o toque
+// mantém o contato persistente
+void Simulation::resolveFlipperOverlaps() {
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+
+  auto resolve = [&](Flipper const &flipper, bool isLeft,
+                     FlipperContact &flipperContact) {
+    RotatingCapsule capsule =
+        flipperCapsule(flipper, isLeft, flipper.currentAngle);
+    glm::vec2 closest =
+        Collision::closestPointOnCapsule(capsule, m_ball.position, 0.0f);
+    glm::vec2 offset = m_ball.position - closest;
+    float minDistance = scaledBallRadius + flipper.radius;
+    float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared >= minDistance * minDistance || distanceSquared <= 0.0f)
+      return;
+
+    glm::vec2 normal = offset / std::sqrt(distanceSquared);
+    m_ball.position = closest + normal * minDistance;
+    m_ball.velocity = Collision::resolveVelocity(
+        m_ball.velocity, normal,
+        Collision::capsuleSurfaceVelocity(capsule, closest), 0.0f,
+        flipper.friction);
+    static_cast<void>(touchFlipper(flipperContact));
+  };
+
+  resolve(m_leftFlipper, true, m_leftFlipperContact);
+  resolve(m_rightFlipper, false, m_rightFlipperContact);
+}
+
+// Rede de segurança da detecção contínua: se a bola terminar o passo
+// sobreposta a um elemento da mesa (por exemplo, empurrada por um flipper),
+// ela é empurrada para fora ao longo da normal, e a componente da velocidade
+// em direção ao elemento é refletida
+void Simulation::resolveTableOverlaps() {
+  float scaledBallRadius = m_ball.radius * GAME_SCALE;
+
+  auto pushOut = [&](glm::vec2 closest, float minDistance, float restitution) {
+    glm::vec2 offset = m_ball.position - closest;
+    float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared >= minDistance * minDistance || distanceSquared <= 0.0f)
+      return;
+
+    glm::vec2 normal = offset / std::sqrt(distanceSquared);
+    m_ball.position = closest + normal * minDistance;
+    float normalSpeed = glm::dot(m_ball.velocity, normal);
+    if (normalSpeed < 0.0f)
+      m_ball.velocity -= (1.0f + restitution) * normalSpeed * normal;
+  };
+
+  for (auto const &segment : m_table.getSegments()) {
+    pushOut(Collision::closestPointOnSegment(m_ball.position, segment.a,
+                                             segment.b),
+            scaledBallRadius, segment.restitution);
+  }
+  for (auto const &arc : m_table.getArcs()) {
+    if (!Collision::isNearCircle(m_ball.position, arc.center, arc.radius,
+                                 scaledBallRadius))
+      continue;
+    pushOut(Collision::closestPointOnArc(m_ball.position, arc.center,
+                                         arc.radius, arc.startAngle,
+                                         arc.endAngle),
+            scaledBallRadius, arc.restitution);
+  }
+  for (auto const &bumper : m_table.getBumpers()) {
+    pushOut(bumper.position, scaledBallRadius + bumper.radius,
+            bumper.restitution);
+  }
+}
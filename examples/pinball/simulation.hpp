@@ -0,0 +1,204 @@
+#ifndef SIMULATION_HPP_
+#define SIMULATION_HPP_
+
+#include "ballset.hpp"
+#include "gamedata.hpp"
+#include "spatialgrid.hpp"
+#include "table.hpp"
+#include "timestep.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <vector>
+
+// Distribuições usadas para gerar layouts aleatórios de obstáculos
+struct LayoutSettings {
+  int count{6};
+  glm::vec2 positionX{WALL_LEFT + 0.2f, WALL_RIGHT - 0.2f};
+  glm::vec2 positionY{-0.2f, WALL_TOP - 0.2f};
+  glm::vec2 radius{0.1f, 0.3f};
+};
+
+// Colisão da bola principal com um elemento da mesa
+struct CollisionEvent {
+  enum class Kind : std::uint8_t { Flipper, Obstacle, Wall };
+
+  Kind kind{};
+  // Passo em que ocorreu e ponto de contato da bola
+  std::uint64_t tick{};
+  glm::vec2 position{};
+  // Velocidade de aproximação ao longo da normal, antes do impacto
+  float impactSpeed{};
+};
+
+// Física do pinball: bola, flippers, obstáculos, paredes e multibola.
+//
+// As paredes, os bumpers, os flippers e a posição inicial da bola vêm da
+// mesa (Table); os obstáculos formam o layout aleatório sobre ela.
+//
+// Não depende de SDL nem de OpenGL, de modo que a mesma simulação é usada pela
+// janela do jogo e pelas ferramentas sem interface gráfica (pinball_sim), que
+// a avançam mais rápido que o tempo real a partir de entradas roteirizadas.
+class Simulation {
+public:
+  // Entradas do jogador, independentes da biblioteca de janelas
+  enum class Input {
+    Launch,
+    LeftFlipperDown,
+    LeftFlipperUp,
+    RightFlipperDown,
+    RightFlipperUp,
+    MultiBall
+  };
+
+  Simulation();
+
+  // Volta a bola, os flippers e o contador de passos ao estado inicial, sem
+  // alterar os obstáculos
+  void reset();
+
+  // Troca a mesa e volta ao estado inicial (reset)
+  void setTable(Table table);
+  [[nodiscard]] Table const &getTable() const noexcept { return m_table; }
+
+  // Gera obstáculos aleatórios; a mesma semente gera o mesmo layout
+  void generateObstacles(std::uint32_t seed, int count = 6);
+  void generateObstacles(std::uint32_t seed, LayoutSettings const &settings);
+  // Usa um layout pronto; seed é a semente que o gerou, se houver
+  void setObstacles(std::vector<Obstacle> obstacles, std::uint32_t seed = 0);
+  [[nodiscard]] std::uint32_t getSeed() const noexcept { return m_seed; }
+  // Muda a cada troca da mesa ou dos obstáculos, de modo que quem guarda uma
+  // cópia deles (como a camada estática da renderização) sabe quando
+  // refazê-la. Nunca é 0
+  [[nodiscard]] std::uint64_t getLayoutVersion() const noexcept {
+    return m_layoutVersion;
+  }
+
+  void handleInput(Input input);
+
+  // Acumula o tempo do frame e simula os passos fixos correspondentes;
+  // retorna quantos passos foram simulados
+  int update(double frameTime);
+  // Simula um único passo fixo, se a bola estiver em jogo
+  void step();
+
+  [[nodiscard]] FixedTimestep &getTimestep() noexcept { return m_timestep; }
+  [[nodiscard]] FixedTimestep const &getTimestep() const noexcept {
+    return m_timestep;
+  }
+
+  // Velocidade dada à bola por Input::Launch; setTable a redefine com a
+  // velocidade da mesa
+  void setLaunchVelocity(glm::vec2 velocity) noexcept {
+    m_launchVelocity = velocity;
+  }
+  [[nodiscard]] glm::vec2 getLaunchVelocity() const noexcept {
+    return m_launchVelocity;
+  }
+
+  // Quando habilitado, cada colisão da bola principal é acumulada até
+  // clearCollisionEvents()
+  void setCollisionEventsEnabled(bool enabled) noexcept {
+    m_collisionEventsEnabled = enabled;
+  }
+  [[nodiscard]] std::vector<CollisionEvent> const &
+  getCollisionEvents() const noexcept {
+    return m_collisionEvents;
+  }
+  void clearCollisionEvents() noexcept { m_collisionEvents.clear(); }
+
+  void setMultiBallCount(int count) noexcept { m_multiBallCount = count; }
+  [[nodiscard]] int getMultiBallCount() const noexcept {
+    return m_multiBallCount;
+  }
+
+  [[nodiscard]] bool isStarted() const noexcept { return m_started; }
+  // Número de passos simulados desde a criação
+  [[nodiscard]] std::uint64_t getTick() const noexcept { return m_tick; }
+  // Número de vezes em que a bola caiu pelo fundo da mesa
+  [[nodiscard]] int getDrainCount() const noexcept { return m_drainCount; }
+
+  [[nodiscard]] Ball const &getBall() const noexcept { return m_ball; }
+  [[nodiscard]] Flipper const &getLeftFlipper() const noexcept {
+    return m_leftFlipper;
+  }
+  [[nodiscard]] Flipper const &getRightFlipper() const noexcept {
+    return m_rightFlipper;
+  }
+  [[nodiscard]] std::vector<Obstacle> const &getObstacles() const noexcept {
+    return m_obstacles;
+  }
+  [[nodiscard]] BallSet const &getMultiBalls() const noexcept {
+    return m_multiBalls;
+  }
+
+private:
+  // Acesso às etapas internas da física, medidas pelo pinball_bench
+  friend struct SimulationBenchmark;
+
+  Table m_table{Table::builtin()};
+  Ball m_ball;
+  Flipper m_leftFlipper;
+  Flipper m_rightFlipper;
+  std::vector<Obstacle> m_obstacles;
+  std::uint32_t m_seed{};
+  std::uint64_t m_layoutVersion{1};
+  SpatialGrid m_obstacleGrid;
+  std::vector<std::uint32_t> m_obstacleCandidates;
+  FixedTimestep m_timestep;
+
+  // Bolas extras do modo multibola
+  BallSet m_multiBalls;
+  int m_multiBallCount{64};
+
+  glm::vec2 m_launchVelocity{};
+  bool m_started{false};
+  std::uint64_t m_tick{};
+  int m_drainCount{};
+
+  bool m_collisionEventsEnabled{false};
+  std::vector<CollisionEvent> m_collisionEvents;
+
+  void setupBall();
+  void setupFlippers();
+  void launch();
+  void startMultiBall();
+  void stepPhysics(float deltaTime);
+  void stepMultiBalls(float deltaTime);
+
+  // Contato da bola principal com um flipper. Um contato que continua nos
+  // passos seguintes (bola apoiada ou rolando sobre o flipper) é o mesmo
+  // contato: não gera novos eventos de colisão enquanto não houver um impacto
+  struct FlipperContact {
+    bool active{};
+    // Último passo em que a bola tocou o flipper
+    std::uint64_t lastTick{};
+  };
+  FlipperContact m_leftFlipperContact;
+  FlipperContact m_rightFlipperContact;
+
+  // Primeiro contato encontrado durante a varredura de um passo
+  struct Contact {
+    float time{};
+    glm::vec2 normal{};
+    glm::vec2 surfaceVelocity{};
+    float restitution{};
+    float friction{};
+    bool hit{};
+    CollisionEvent::Kind kind{};
+    // Estado do contato, se o elemento for um flipper
+    FlipperContact *flipperContact{};
+  };
+
+  void moveBall(float deltaTime);
+  void resolveContact(Contact const &contact);
+  void checkCollisionWithFlippers(Contact &contact, float elapsed);
+  void checkCollisionWithTable(Contact &contact);
+  void checkCollisionWithObstacles(Contact &contact);
+  void rebuildObstacleGrid();
+  void checkCollisions();
+  void resolveTableOverlaps();
+  void resolveFlipperOverlaps();
+  [[nodiscard]] bool touchFlipper(FlipperContact &contact) noexcept;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "spatialgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <limits>
+#include <utility>
+
+void SpatialGrid::clear() {
+  m_columns = 0;
+  m_rows = 0;
+  m_cellStart.clear();
+  m_indices.clear();
+  m_stamps.clear();
+}
+
+void SpatialGrid::build(std::vector<Obstacle> const &obstacles,
+                        float cellSize) {
+  clear();
+  if (obstacles.empty())
+    return;
+
+  // Limites do layout e maior raio de colisão
+  glm::vec2 min{obstacles.front().position};
+  glm::vec2 max{min};
+  float maxRadius{0.0f};
+  for (auto const &obstacle : obstacles) {
+    auto const radius{obstacle.collisionRadius()};
+    min = glm::min(min, obstacle.position - radius);
+    max = glm::max(max, obstacle.position + radius);
+    maxRadius = std::max(maxRadius, radius);
+  }
+
+  // Por padrão, cada célula tem o diâmetro do maior obstáculo, de modo que
+  // cada obstáculo ocupe no máximo quatro células
+  m_cellSize = cellSize > 0.0f ? cellSize : std::max(2.0f * maxRadius, 1e-3f);
+  m_origin = min;
+  auto const extent{max - min};
+  if (std::isfinite(extent.x) && std::isfinite(extent.y) &&
+      std::isfinite(m_cellSize)) {
+    // Número de células em cada eixo, em double para que nem a conversão
+    // nem o produto transbordem
+    auto const cellCounts{[&extent](float size) {
+      return std::pair{std::max(1.0, std::ceil(double{extent.x} / size)),
+                       std::max(1.0, std::ceil(double{extent.y} / size))};
+    }};
+    while (true) {
+      auto const [columns, rows]{cellCounts(m_cellSize)};
+      if (columns * rows <= static_cast<double>(maxCells))
+        break;
+      m_cellSize *= 2.0f;
+    }
+    auto const [columns, rows]{cellCounts(m_cellSize)};
+    m_columns = static_cast<int>(columns);
+    m_rows = static_cast<int>(rows);
+  } else {
+    // Posições inválidas: uma única célula infinita, com todos os obstáculos
+    m_cellSize = std::numeric_limits<float>::infinity();
+    m_columns = 1;
+    m_rows = 1;
+  }
+
+  auto const numCells{static_cast<std::size_t>(m_columns) *
+                      static_cast<std::size_t>(m_rows)};
+  m_cellStart.assign(numCells + 1, 0);
+
+  // Primeira passada: conta os obstáculos de cada célula
+  auto forEachCell = [&](Obstacle const &obstacle, auto &&function) {
+    auto const radius{obstacle.collisionRadius()};
+    auto const first{cellOf(obstacle.position - radius)};
+    auto const last{cellOf(obstacle.position + radius)};
+    for (int row = first.y; row <= last.y; ++row) {
+      for (int column = first.x; column <= last.x; ++column) {
+        function(static_cast<std::size_t>(row * m_columns + column));
+      }
+    }
+  };
+  for (auto const &obstacle : obstacles) {
+    forEachCell(obstacle, [&](std::size_t cell) { ++m_cellStart[cell + 1]; });
+  }
+
+  // Soma de prefixos: m_cellStart[c] é o início da célula c
+  for (std::size_t cell = 0; cell < numCells; ++cell) {
+    m_cellStart[cell + 1] += m_cellStart[cell];
+  }
+
+  // Segunda passada: preenche os índices
+  m_indices.resize(m_cellStart[numCells]);
+  auto cursor{m_cellStart};
+  for (std::uint32_t index = 0; index < obstacles.size(); ++index) {
+    forEachCell(obstacles[index],
+                [&](std::size_t cell) { m_indices[cursor[cell]++] = index; });
+  }
+
+  m_stamps.assign(obstacles.size(), 0);
+  m_queryStamp = 0;
+}
+
+void SpatialGrid::query(glm::vec2 min, glm::vec2 max,
+                        std::vector<std::uint32_t> &result) const {
+  if (m_indices.empty())
+    return;
+
+  // Caixa fora da grade
+  auto const gridMax{m_origin + glm::vec2{m_columns, m_rows} * m_cellSize};
+  if (max.x < m_origin.x || max.y < m_origin.y || min.x > gridMax.x ||
+      min.y > gridMax.y)
+    return;
+
+  // Nova marca; ao dar a volta, zera as marcas antigas
+  if (++m_queryStamp == 0) {
+    std::fill(m_stamps.begin(), m_stamps.end(), 0);
+    m_queryStamp = 1;
+  }
+
+  auto const first{cellOf(min)};
+  auto const last{cellOf(max)};
+  for (int row = first.y; row <= last.y; ++row) {
+    for (int column = first.x; column <= last.x; ++column) {
+      auto const cell{static_cast<std::size_t>(row * m_columns + column)};
+      for (auto i{m_cellStart[cell]}; i < m_cellStart[cell + 1]; ++i) {
+        auto const index{m_indices[i]};
+        if (m_stamps[index] != m_queryStamp) {
+          m_stamps[index] = m_queryStamp;
+          result.push_back(index);
+        }
+      }
+    }
+  }
+}
+
+// Célula que contém o ponto, limitada às bordas da grade. O limite é
+// aplicado ainda em float, antes da conversão para int, que não é definida
+// para valores fora do alcance de int ou NaN. Na ordem std::max(0, min(x,
+// last)), um NaN resulta em zero
+glm::ivec2 SpatialGrid::cellOf(glm::vec2 point) const {
+  auto const cell{glm::floor((point - m_origin) / m_cellSize)};
+  auto const limit{[](float value, int last) {
+    return static_cast<int>(
+        std::max(0.0f, std::min(value, static_cast<float>(last))));
+  }};
+  return {limit(cell.x, m_columns - 1), limit(cell.y, m_rows - 1)};
+}
@@ -0,0 +1,50 @@
+#ifndef SPATIALGRID_HPP_
+#define SPATIALGRID_HPP_
+
+#include "gamedata.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <vector>
+
+// Grade uniforme usada como fase ampla (broad phase) das colisões com os
+// obstáculos. É construída uma única vez a partir do layout e deve ser
+// reconstruída sempre que os obstáculos mudarem. Os índices de cada célula
+// ficam armazenados de forma contígua (CSR), sem alocação durante as
+// consultas.
+class SpatialGrid {
+public:
+  // Limite de células da grade: com obstáculos pequenos espalhados por uma
+  // área grande, as células crescem até a grade caber nele
+  static constexpr std::size_t maxCells{std::size_t{1} << 16};
+
+  void build(std::vector<Obstacle> const &obstacles, float cellSize = 0.0f);
+  void clear();
+
+  // Adiciona a result os índices dos obstáculos cujas células intersectam a
+  // caixa [min, max], sem repetições
+  void query(glm::vec2 min, glm::vec2 max,
+             std::vector<std::uint32_t> &result) const;
+
+  [[nodiscard]] float getCellSize() const noexcept { return m_cellSize; }
+  [[nodiscard]] bool empty() const noexcept { return m_indices.empty(); }
+
+private:
+  [[nodiscard]] glm::ivec2 cellOf(glm::vec2 point) const;
+
+  glm::vec2 m_origin{};
+  float m_cellSize{1.0f};
+  int m_columns{};
+  int m_rows{};
+
+  // Início de cada célula em m_indices (m_columns * m_rows + 1 entradas)
+  std::vector<std::uint32_t> m_cellStart;
+  std::vector<std::uint32_t> m_indices;
+
+  // Marca de consulta por obstáculo, para não repetir obstáculos que ocupam
+  // mais de uma célula
+  mutable std::vector<std::uint32_t> m_stamps;
+  mutable std::uint32_t m_queryStamp{};
+};
+
+#endif
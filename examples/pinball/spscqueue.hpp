@@ -0,0 +1,44 @@
+#ifndef SPSCQUEUE_HPP_
+#define SPSCQUEUE_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Fila circular sem travas para um produtor e um consumidor, em threads
+// diferentes, com capacidade fixa (potência de dois). push falha com a fila
+// cheia, em vez de esperar.
+template <typename T, std::size_t Capacity> class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+public:
+  // Produtor
+  bool push(T const &value) noexcept {
+    auto const head{m_head.load(std::memory_order_relaxed)};
+    if (head - m_tail.load(std::memory_order_acquire) == Capacity)
+      return false;
+    m_items[head & (Capacity - 1)] = value;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumidor
+  std::optional<T> pop() noexcept {
+    auto const tail{m_tail.load(std::memory_order_relaxed)};
+    if (tail == m_head.load(std::memory_order_acquire))
+      return std::nullopt;
+    auto value{m_items[tail & (Capacity - 1)]};
+    m_tail.store(tail + 1, std::memory_order_release);
+    return value;
+  }
+
+private:
+  std::array<T, Capacity> m_items{};
+  // Contadores crescentes; o índice no array é o resto por Capacity
+  alignas(64) std::atomic<std::size_t> m_head{0};
+  alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+#endif
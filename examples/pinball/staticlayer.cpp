@@ -0,0 +1,73 @@
+#include "staticlayer.hpp"
+
+namespace {
+void checkFramebuffer() {
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    throw abcg::RuntimeError("Failed to create the static layer framebuffer");
+}
+} // namespace
+
+// Deve ser chamada com o framebuffer da tela ligado, que é religado ao final
+StaticLayer StaticLayer::create(glm::ivec2 size, int samples) {
+  StaticLayer layer{.size = size};
+
+  GLint screenFramebuffer{};
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &screenFramebuffer);
+
+  // A textura tem exatamente o tamanho da tela: cada texel é lido por um
+  // único pixel, sem filtragem
+  glGenTextures(1, &layer.texture);
+  glBindTexture(GL_TEXTURE_2D, layer.texture);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA,
+               GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenFramebuffers(1, &layer.framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, layer.framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         layer.texture, 0);
+  checkFramebuffer();
+
+  if (samples > 1) {
+    glGenRenderbuffers(1, &layer.multisampleRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, layer.multisampleRenderbuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8,
+                                     size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &layer.multisampleFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.multisampleFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                              GL_RENDERBUFFER, layer.multisampleRenderbuffer);
+    checkFramebuffer();
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(screenFramebuffer));
+  return layer;
+}
+
+void StaticLayer::destroy() {
+  if (framebuffer != 0)
+    glDeleteFramebuffers(1, &framebuffer);
+  if (texture != 0)
+    glDeleteTextures(1, &texture);
+  if (multisampleFramebuffer != 0)
+    glDeleteFramebuffers(1, &multisampleFramebuffer);
+  if (multisampleRenderbuffer != 0)
+    glDeleteRenderbuffers(1, &multisampleRenderbuffer);
+  *this = {};
+}
+
+void StaticLayer::resolve() const {
+  if (multisampleFramebuffer == 0)
+    return;
+
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, multisampleFramebuffer);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+  glBlitFramebuffer(0, 0, size.x, size.y, 0, 0, size.x, size.y,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
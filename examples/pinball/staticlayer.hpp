@@ -0,0 +1,36 @@
+#ifndef STATICLAYER_HPP_
+#define STATICLAYER_HPP_
+
+#include "abcgOpenGL.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+// Camada estática do jogo: o fundo, a mesa e os obstáculos, que não se movem
+// durante uma rodada, desenhados uma única vez em uma textura do tamanho da
+// tela. A cada frame, a textura é copiada para a tela com um único quadrado,
+// de modo que o custo do frame não depende da complexidade da mesa.
+//
+// Com MSAA, a camada é desenhada em um renderbuffer com várias amostras e
+// resolvida na textura, para que as paredes mantenham as bordas suavizadas.
+struct StaticLayer {
+  GLuint framebuffer{};
+  GLuint texture{};
+  GLuint multisampleFramebuffer{};
+  GLuint multisampleRenderbuffer{};
+  glm::ivec2 size{};
+  // Versão do layout desenhado (Simulation::getLayoutVersion); 0 se a camada
+  // ainda não foi desenhada
+  std::uint64_t layoutVersion{};
+
+  static StaticLayer create(glm::ivec2 size, int samples);
+  void destroy();
+
+  // Framebuffer em que a camada deve ser desenhada
+  [[nodiscard]] GLuint drawFramebuffer() const noexcept {
+    return multisampleFramebuffer != 0 ? multisampleFramebuffer : framebuffer;
+  }
+  // Com MSAA, copia as amostras resolvidas para a textura
+  void resolve() const;
+};
+
+#endif
@@ -0,0 +1,416 @@
+#include "table.hpp"
+#include "mappedfile.hpp"
+#include "tabledefault.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+
+constexpr std::array<char, 4> magic{'P', 'B', 'T', 'B'};
+constexpr std::uint32_t version{3};
+// Lido com outro valor em uma máquina de ordem de bytes diferente
+constexpr std::uint32_t byteOrderMark{0x01020304};
+
+// Cabeçalho do formato binário, seguido dos arrays de segmentos, arcos e
+// bumpers. Todos os campos têm 4 bytes, de modo que os arrays ficam
+// alinhados logo após o cabeçalho. O tamanho e o hash do texto de origem
+// identificam a descrição compilada: Table::load só usa a versão compilada
+// se eles coincidirem com os do texto atual
+struct Header {
+  std::array<char, 4> magic;
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint32_t sourceSize;
+  std::array<std::uint32_t, 2> sourceHash;
+  std::uint32_t segmentCount;
+  std::uint32_t arcCount;
+  std::uint32_t bumperCount;
+  TableSettings settings;
+  TableFlipper leftFlipper;
+  TableFlipper rightFlipper;
+};
+
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(sizeof(Header) % alignof(TableSegment) == 0);
+static_assert(alignof(TableSegment) == 4 && alignof(TableArc) == 4 &&
+              alignof(TableBumper) == 4);
+
+constexpr float defaultWallRestitution{0.8f};
+constexpr float defaultBumperRestitution{1.0f};
+constexpr float defaultFlipperRestitution{0.6f};
+constexpr float defaultFlipperFriction{0.2f};
+
+float radians(float degrees) {
+  return degrees * static_cast<float>(M_PI) / 180.0f;
+}
+
+// Elementos lidos do texto, antes da compilação
+struct Description {
+  TableSettings settings;
+  std::optional<glm::vec2> ballPosition;
+  std::optional<glm::vec2> launchVelocity;
+  std::optional<TableFlipper> leftFlipper;
+  std::optional<TableFlipper> rightFlipper;
+  bool hasDrain{};
+  std::vector<TableSegment> segments;
+  std::vector<TableArc> arcs;
+  std::vector<TableBumper> bumpers;
+};
+
+// Uma linha da descrição: o nome do elemento seguido de números
+class Line {
+public:
+  Line(int number, std::string_view text) : m_number{number} {
+    std::istringstream stream{std::string{text}};
+    std::string word;
+    while (stream >> word) {
+      m_words.push_back(word);
+    }
+  }
+
+  [[nodiscard]] bool empty() const { return m_words.empty(); }
+  [[nodiscard]] std::string const &word(std::size_t index) const {
+    return m_words.at(index);
+  }
+
+  // Exige entre min e max números a partir da palavra first
+  void expect(std::size_t first, std::size_t min, std::size_t max) const {
+    auto const count{m_words.size() > first ? m_words.size() - first : 0};
+    if (count < min || count > max)
+      fail(fmt::format("'{}' expects {} to {} values", m_words[0], min, max));
+  }
+
+  [[nodiscard]] float number(std::size_t index) const {
+    auto const &text{m_words[index]};
+    float value{};
+    auto const *last{text.data() + text.size()};
+    auto const [ptr, ec]{std::from_chars(text.data(), last, value)};
+    if (ec != std::errc{} || ptr != last)
+      fail(fmt::format("invalid number '{}'", text));
+    return value;
+  }
+
+  [[nodiscard]] float numberOr(std::size_t index, float fallback) const {
+    return index < m_words.size() ? number(index) : fallback;
+  }
+
+  [[noreturn]] void fail(std::string_view message) const {
+    throw std::runtime_error(
+        fmt::format("Table line {}: {}", m_number, message));
+  }
+
+private:
+  int m_number;
+  std::vector<std::string> m_words;
+};
+
+void parseLine(Line const &line, Description &description) {
+  auto const &element{line.word(0)};
+
+  if (element == "segment") {
+    line.expect(1, 4, 5);
+    description.segments.push_back(
+        {.a = {line.number(1), line.number(2)},
+         .b = {line.number(3), line.number(4)},
+         .restitution = line.numberOr(5, defaultWallRestitution)});
+  } else if (element == "arc") {
+    line.expect(1, 5, 6);
+    auto const startAngle{line.number(4)};
+    auto const endAngle{line.number(5)};
+    if (endAngle <= startAngle || endAngle - startAngle > 360.0f)
+      line.fail("arc angles must satisfy start < end <= start + 360");
+    description.arcs.push_back(
+        {.center = {line.number(1), line.number(2)},
+         .radius = line.number(3),
+         .startAngle = radians(startAngle),
+         .endAngle = radians(endAngle),
+         .restitution = line.numberOr(6, defaultWallRestitution)});
+  } else if (element == "bumper") {
+    line.expect(1, 3, 4);
+    description.bumpers.push_back(
+        {.position = {line.number(1), line.number(2)},
+         .radius = line.number(3),
+         .restitution = line.numberOr(4, defaultBumperRestitution)});
+  } else if (element == "flipper") {
+    line.expect(2, 6, 8);
+    TableFlipper const flipper{
+        .pivot = {line.number(2), line.number(3)},
+        .length = line.number(4),
+        .radius = line.number(5),
+        .restAngle = radians(line.number(6)),
+        .activeAngle = radians(line.number(7)),
+        .restitution = line.numberOr(8, defaultFlipperRestitution),
+        .friction = line.numberOr(9, defaultFlipperFriction)};
+    if (line.word(1) == "left")
+      description.leftFlipper = flipper;
+    else if (line.word(1) == "right")
+      description.rightFlipper = flipper;
+    else
+      line.fail("flipper side must be 'left' or 'right'");
+  } else if (element == "ball") {
+    line.expect(1, 3, 3);
+    description.ballPosition = {line.number(1), line.number(2)};
+    description.settings.ballRadius = line.number(3);
+  } else if (element == "launch") {
+    line.expect(1, 2, 2);
+    description.launchVelocity = {line.number(1), line.number(2)};
+  } else if (element == "drain") {
+    line.expect(1, 1, 1);
+    description.settings.drainHeight = line.number(1);
+    description.hasDrain = true;
+  } else {
+    line.fail(fmt::format("unknown element '{}'", element));
+  }
+}
+
+template <typename T>
+void append(std::vector<std::byte> &data, std::vector<T> const &elements) {
+  auto const offset{data.size()};
+  data.resize(offset + elements.size() * sizeof(T));
+  if (!elements.empty())
+    std::memcpy(data.data() + offset, elements.data(),
+                elements.size() * sizeof(T));
+}
+
+// FNV-1a de 64 bits
+std::array<std::uint32_t, 2> hashSource(std::string_view text) {
+  std::uint64_t hash{14695981039346656037ULL};
+  for (auto const character : text) {
+    hash ^= static_cast<std::uint8_t>(character);
+    hash *= 1099511628211ULL;
+  }
+  return {static_cast<std::uint32_t>(hash),
+          static_cast<std::uint32_t>(hash >> 32)};
+}
+
+std::vector<std::byte> compile(Description const &description,
+                               std::string_view source) {
+  Header const header{
+      .magic = magic,
+      .version = version,
+      .byteOrder = byteOrderMark,
+      .sourceSize = static_cast<std::uint32_t>(source.size()),
+      .sourceHash = hashSource(source),
+      .segmentCount = static_cast<std::uint32_t>(description.segments.size()),
+      .arcCount = static_cast<std::uint32_t>(description.arcs.size()),
+      .bumperCount = static_cast<std::uint32_t>(description.bumpers.size()),
+      .settings = description.settings,
+      .leftFlipper = *description.leftFlipper,
+      .rightFlipper = *description.rightFlipper};
+
+  std::vector<std::byte> data(sizeof(Header));
+  std::memcpy(data.data(), &header, sizeof(Header));
+  append(data, description.segments);
+  append(data, description.arcs);
+  append(data, description.bumpers);
+  return data;
+}
+
+template <typename T>
+std::span<T const> elementsAt(std::span<std::byte const> data,
+                              std::size_t &offset, std::uint32_t count) {
+  std::span const elements{
+      reinterpret_cast<T const *>(data.data() + offset), count};
+  offset += elements.size_bytes();
+  return elements;
+}
+
+} // namespace
+
+Table const &Table::builtin() {
+  static Table const table{parse(defaultTableText)};
+  return table;
+}
+
+Table Table::parse(std::string_view text) {
+  auto const source{text};
+  Description description;
+
+  int lineNumber{0};
+  while (!text.empty()) {
+    auto const end{text.find('\n')};
+    auto lineText{text.substr(0, end)};
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    ++lineNumber;
+
+    // Comentários começam com #
+    if (auto const comment{lineText.find('#')};
+        comment != std::string_view::npos)
+      lineText = lineText.substr(0, comment);
+
+    if (Line const line{lineNumber, lineText}; !line.empty())
+      parseLine(line, description);
+  }
+
+  if (!description.ballPosition || !description.launchVelocity ||
+      !description.hasDrain)
+    throw std::runtime_error("Table is missing 'ball', 'launch' or 'drain'");
+  if (!description.leftFlipper || !description.rightFlipper)
+    throw std::runtime_error("Table needs a left and a right flipper");
+  description.settings.ballPosition = *description.ballPosition;
+  description.settings.launchVelocity = *description.launchVelocity;
+
+  auto data{std::make_shared<std::vector<std::byte> const>(
+      compile(description, source))};
+  std::span<std::byte const> const bytes{*data};
+  return decode(std::move(data), bytes);
+}
+
+Table Table::load(std::string const &path) {
+  std::filesystem::path compiledPath{path};
+  compiledPath.replace_extension(".pbtb");
+
+  std::ifstream file(path);
+  std::stringstream text;
+  text << file.rdbuf();
+  if (!file)
+    throw std::runtime_error("Failed to read " + path);
+  auto const source{text.str()};
+
+  // Usa a versão compilada se ela veio deste mesmo texto (tamanho e hash,
+  // e não a data de modificação, que uma cópia preserva e cuja resolução
+  // pode ser de segundos). Um arquivo de outra versão do formato, ou de
+  // outro texto, é simplesmente recompilado
+  if (std::filesystem::exists(compiledPath)) {
+    try {
+      auto compiled{map(compiledPath.string())};
+      Header header{};
+      std::memcpy(&header, compiled.getData().data(), sizeof(Header));
+      if (header.sourceSize == source.size() &&
+          header.sourceHash == hashSource(source))
+        return compiled;
+    } catch (std::runtime_error const &) {
+    }
+  }
+
+  auto table{parse(source)};
+
+  // A versão compilada é apenas um cache: se não puder ser gravada (por
+  // exemplo, em um diretório somente leitura), a mesa é usada da memória
+  try {
+    table.save(compiledPath.string());
+  } catch (std::runtime_error const &) {
+  }
+  return table;
+}
+
+Table Table::map(std::string const &path) {
+  auto file{std::make_shared<MappedFile const>(path)};
+  auto const data{file->getData()};
+  try {
+    return decode(std::move(file), data);
+  } catch (std::runtime_error const &exception) {
+    throw std::runtime_error(fmt::format("{}: {}", path, exception.what()));
+  }
+}
+
+Table Table::fromData(std::span<std::byte const> data) {
+  auto copy{std::make_shared<std::vector<std::byte> const>(data.begin(),
+                                                           data.end())};
+  std::span<std::byte const> const bytes{*copy};
+  return decode(std::move(copy), bytes);
+}
+
+void Table::save(std::string const &path) const {
+  // Grava em um arquivo temporário e o renomeia, para que um processo que
+  // esteja com a versão anterior mapeada não a veja pela metade
+  auto const temporaryPath{path + ".tmp"};
+  {
+    std::ofstream file(temporaryPath, std::ios::binary);
+    file.write(reinterpret_cast<char const *>(m_data.data()),
+               static_cast<std::streamsize>(m_data.size()));
+    if (!file)
+      throw std::runtime_error("Failed to write " + temporaryPath);
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporaryPath, path, error);
+  if (error) {
+    std::filesystem::remove(temporaryPath, error);
+    throw std::runtime_error("Failed to write " + path);
+  }
+}
+
+Table Table::decode(std::shared_ptr<void const> owner,
+                    std::span<std::byte const> data) {
+  Header header{};
+  if (data.size() < sizeof(Header))
+    throw std::runtime_error("Invalid table data");
+  std::memcpy(&header, data.data(), sizeof(Header));
+  if (header.magic != magic)
+    throw std::runtime_error("Invalid table data");
+  if (header.version != version || header.byteOrder != byteOrderMark)
+    throw std::runtime_error("Unsupported table format");
+
+  auto const expectedSize{sizeof(Header) +
+                          header.segmentCount * sizeof(TableSegment) +
+                          header.arcCount * sizeof(TableArc) +
+                          header.bumperCount * sizeof(TableBumper)};
+  if (data.size() != expectedSize)
+    throw std::runtime_error("Truncated table data");
+
+  Table table;
+  table.m_owner = std::move(owner);
+  table.m_data = data;
+  table.m_settings = header.settings;
+  table.m_leftFlipper = header.leftFlipper;
+  table.m_rightFlipper = header.rightFlipper;
+
+  std::size_t offset{sizeof(Header)};
+  table.m_segments =
+      elementsAt<TableSegment>(data, offset, header.segmentCount);
+  table.m_arcs = elementsAt<TableArc>(data, offset, header.arcCount);
+  table.m_bumpers = elementsAt<TableBumper>(data, offset, header.bumperCount);
+  return table;
+}
+
+TableMesh Table::tessellate(int arcSegments, int bumperSegments) const {
+  TableMesh mesh;
+
+  for (auto const &segment : m_segments) {
+    mesh.vertices.push_back(segment.a);
+    mesh.vertices.push_back(segment.b);
+  }
+
+  for (auto const &arc : m_arcs) {
+    auto const pointAt = [&](int i) {
+      auto const angle{arc.startAngle + (arc.endAngle - arc.startAngle) *
+                                            static_cast<float>(i) /
+                                            static_cast<float>(arcSegments)};
+      return arc.center +
+             arc.radius * glm::vec2{std::cos(angle), std::sin(angle)};
+    };
+    for (int i = 0; i < arcSegments; ++i) {
+      mesh.vertices.push_back(pointAt(i));
+      mesh.vertices.push_back(pointAt(i + 1));
+    }
+  }
+  mesh.lineVertices = mesh.vertices.size();
+
+  // Centro, seguido dos pontos da borda; o último repete o primeiro
+  mesh.fanSize = static_cast<std::size_t>(bumperSegments) + 2;
+  mesh.fanCount = m_bumpers.size();
+  for (auto const &bumper : m_bumpers) {
+    mesh.vertices.push_back(bumper.position);
+    for (int i = 0; i <= bumperSegments; ++i) {
+      auto const angle{2.0f * static_cast<float>(M_PI) *
+                       static_cast<float>(i) /
+                       static_cast<float>(bumperSegments)};
+      mesh.vertices.push_back(bumper.position +
+                              bumper.radius *
+                                  glm::vec2{std::cos(angle), std::sin(angle)});
+    }
+  }
+
+  return mesh;
+}
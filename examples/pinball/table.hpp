@@ -0,0 +1,144 @@
+#ifndef TABLE_HPP_
+#define TABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Elementos da mesa, em coordenadas do mundo e com ângulos em radianos. Estas
+// estruturas são gravadas sem conversão no arquivo binário e lidas
+// diretamente do mapeamento em memória, por isso contêm apenas floats.
+
+// Posição inicial da bola, velocidade de lançamento e altura abaixo da qual a
+// bola é considerada perdida
+struct TableSettings {
+  glm::vec2 ballPosition{};
+  float ballRadius{};
+  glm::vec2 launchVelocity{};
+  float drainHeight{};
+};
+
+struct TableSegment {
+  glm::vec2 a{};
+  glm::vec2 b{};
+  float restitution{};
+};
+
+// Arco de circunferência no sentido anti-horário, de startAngle a endAngle
+// (endAngle > startAngle)
+struct TableArc {
+  glm::vec2 center{};
+  float radius{};
+  float startAngle{};
+  float endAngle{};
+  float restitution{};
+};
+
+struct TableBumper {
+  glm::vec2 position{};
+  float radius{};
+  float restitution{};
+};
+
+// O flipper direito é espelhado: aponta para -x e gira no sentido oposto
+struct TableFlipper {
+  glm::vec2 pivot{};
+  float length{};
+  float radius{};
+  // Ângulos com o botão solto e pressionado
+  float restAngle{};
+  float activeAngle{};
+  // Restituição e coeficiente de atrito do contato com a bola
+  float restitution{};
+  float friction{};
+};
+
+// Vértices da mesa para um único buffer da GPU: primeiro lineVertices
+// vértices em pares (GL_LINES) com os segmentos e arcos, depois um leque de
+// triângulos (GL_TRIANGLE_FAN) de fanSize vértices por bumper
+struct TableMesh {
+  std::vector<glm::vec2> vertices;
+  std::size_t lineVertices{};
+  std::size_t fanSize{};
+  std::size_t fanCount{};
+};
+
+// Geometria da mesa: paredes, arcos, bumpers e flippers.
+//
+// A mesa é descrita em um arquivo de texto (assets/table.txt) e compilada em
+// um formato binário compacto: um cabeçalho seguido dos arrays de elementos,
+// prontos para uso. Table::load guarda essa versão compilada ao lado do texto
+// e, nas execuções seguintes, apenas a mapeia em memória, se o texto não
+// mudou. A colisão e a renderização usam os mesmos dados, de modo que um
+// elemento novo na mesa não exige código novo. Cópias de Table compartilham
+// os mesmos dados.
+class Table {
+public:
+  // Mesa padrão, compilada no programa a partir de assets/table.txt
+  static Table const &builtin();
+
+  // Interpreta a descrição textual; o formato está em assets/table.txt
+  static Table parse(std::string_view text);
+  // Carrega uma descrição textual, usando o arquivo compilado (mesmo nome,
+  // extensão .pbtb) se ele foi compilado deste mesmo texto
+  static Table load(std::string const &path);
+  // Mapeia em memória um arquivo compilado
+  static Table map(std::string const &path);
+  // Copia dados no formato binário, como os gravados em um SessionLog
+  static Table fromData(std::span<std::byte const> data);
+
+  // Dados no formato binário
+  [[nodiscard]] std::span<std::byte const> getData() const noexcept {
+    return m_data;
+  }
+  void save(std::string const &path) const;
+
+  [[nodiscard]] TableSettings const &getSettings() const noexcept {
+    return m_settings;
+  }
+  [[nodiscard]] std::span<TableSegment const> getSegments() const noexcept {
+    return m_segments;
+  }
+  [[nodiscard]] std::span<TableArc const> getArcs() const noexcept {
+    return m_arcs;
+  }
+  [[nodiscard]] std::span<TableBumper const> getBumpers() const noexcept {
+    return m_bumpers;
+  }
+  [[nodiscard]] TableFlipper const &getLeftFlipper() const noexcept {
+    return m_leftFlipper;
+  }
+  [[nodiscard]] TableFlipper const &getRightFlipper() const noexcept {
+    return m_rightFlipper;
+  }
+
+  // Aproxima cada arco por arcSegments segmentos e cada bumper por um leque
+  // com bumperSegments triângulos
+  [[nodiscard]] TableMesh tessellate(int arcSegments = 16,
+                                     int bumperSegments = 24) const;
+
+private:
+  Table() = default;
+
+  // Valida os dados e aponta os arrays para dentro deles. owner mantém a
+  // memória (mapeamento ou buffer) viva enquanto houver cópias da mesa
+  static Table decode(std::shared_ptr<void const> owner,
+                      std::span<std::byte const> data);
+
+  std::shared_ptr<void const> m_owner;
+  std::span<std::byte const> m_data;
+
+  TableSettings m_settings;
+  TableFlipper m_leftFlipper;
+  TableFlipper m_rightFlipper;
+  std::span<TableSegment const> m_segments;
+  std::span<TableArc const> m_arcs;
+  std::span<TableBumper const> m_bumpers;
+};
+
+#endif
@@ -0,0 +1,444 @@
+#include "telemetry.hpp"
+#include "bytestream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> telemetryMagic{'P', 'B', 'T', 'M'};
+constexpr std::uint16_t telemetryVersion{3};
+
+// Tipos de bloco
+constexpr std::uint8_t framesBlock{0};
+constexpr std::uint8_t inputsBlock{1};
+// A partir da versão 3
+constexpr std::uint8_t stimuliBlock{2};
+// Último bloco: contadores de registros descartados
+constexpr std::uint8_t endBlock{0xFF};
+
+// Segunda diferença: para valores que crescem em ritmo quase constante, como
+// os instantes dos frames, o resultado fica perto de zero
+class DeltaEncoder {
+public:
+  std::int64_t next(std::int64_t value) noexcept {
+    auto const delta{value - m_previous};
+    auto const result{delta - m_previousDelta};
+    m_previous = value;
+    m_previousDelta = delta;
+    return result;
+  }
+
+private:
+  std::int64_t m_previous{};
+  std::int64_t m_previousDelta{};
+};
+
+class DeltaDecoder {
+public:
+  std::int64_t next(std::int64_t value) noexcept {
+    m_previousDelta += value;
+    m_previous += m_previousDelta;
+    return m_previous;
+  }
+
+private:
+  std::int64_t m_previous{};
+  std::int64_t m_previousDelta{};
+};
+
+template <typename Record, typename Get>
+void writeIntegers(ByteWriter &writer, std::span<Record const> records,
+                   Get get) {
+  DeltaEncoder encoder;
+  for (auto const &record : records) {
+    writer.zigzag(encoder.next(get(record)));
+  }
+}
+
+template <typename Record, typename Set>
+void readIntegers(ByteReader &reader, std::span<Record> records, Set set) {
+  DeltaDecoder decoder;
+  for (auto &record : records) {
+    set(record, decoder.next(reader.zigzag()));
+  }
+}
+
+// XOR com o valor anterior: o sinal, o expoente e os bits mais altos da
+// mantissa costumam se repetir, e viram zeros que o varint descarta
+template <typename Record, typename Get>
+void writeFloats(ByteWriter &writer, std::span<Record const> records,
+                 Get get) {
+  std::uint32_t previous{};
+  for (auto const &record : records) {
+    auto const bits{std::bit_cast<std::uint32_t>(get(record))};
+    writer.varint(bits ^ previous);
+    previous = bits;
+  }
+}
+
+template <typename Record, typename Set>
+void readFloats(ByteReader &reader, std::span<Record> records, Set set) {
+  std::uint32_t previous{};
+  for (auto &record : records) {
+    previous ^= static_cast<std::uint32_t>(reader.varint());
+    set(record, std::bit_cast<float>(previous));
+  }
+}
+
+void encodeFrames(std::span<TelemetryFrame const> frames,
+                  std::vector<std::uint8_t> &data) {
+  ByteWriter writer{data};
+  using Frame = TelemetryFrame;
+  writeIntegers(writer, frames,
+                [](Frame const &frame) { return frame.time.count(); });
+  writeIntegers(writer, frames, [](Frame const &frame) {
+    return static_cast<std::int64_t>(frame.tick);
+  });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.ballPosition.x; });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.ballPosition.y; });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.ballVelocity.x; });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.ballVelocity.y; });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.leftFlipperAngle; });
+  writeFloats(writer, frames,
+              [](Frame const &frame) { return frame.rightFlipperAngle; });
+}
+
+void decodeFrames(ByteReader &reader, std::span<TelemetryFrame> frames) {
+  using Frame = TelemetryFrame;
+  readIntegers(reader, frames, [](Frame &frame, std::int64_t value) {
+    frame.time = std::chrono::nanoseconds{value};
+  });
+  readIntegers(reader, frames, [](Frame &frame, std::int64_t value) {
+    frame.tick = static_cast<std::uint64_t>(value);
+  });
+  readFloats(reader, frames,
+             [](Frame &frame, float value) { frame.ballPosition.x = value; });
+  readFloats(reader, frames,
+             [](Frame &frame, float value) { frame.ballPosition.y = value; });
+  readFloats(reader, frames,
+             [](Frame &frame, float value) { frame.ballVelocity.x = value; });
+  readFloats(reader, frames,
+             [](Frame &frame, float value) { frame.ballVelocity.y = value; });
+  readFloats(reader, frames, [](Frame &frame, float value) {
+    frame.leftFlipperAngle = value;
+  });
+  readFloats(reader, frames, [](Frame &frame, float value) {
+    frame.rightFlipperAngle = value;
+  });
+}
+
+void encodeInputs(std::span<TelemetryInput const> inputs,
+                  std::vector<std::uint8_t> &data) {
+  ByteWriter writer{data};
+  using Input = TelemetryInput;
+  writeIntegers(writer, inputs,
+                [](Input const &input) { return input.time.count(); });
+  writeIntegers(writer, inputs, [](Input const &input) {
+    return static_cast<std::int64_t>(input.tick);
+  });
+  for (auto const &input : inputs) {
+    writer.bytes(static_cast<std::uint8_t>(input.input), 1);
+  }
+}
+
+void decodeInputs(ByteReader &reader, std::span<TelemetryInput> inputs) {
+  using Input = TelemetryInput;
+  readIntegers(reader, inputs, [](Input &input, std::int64_t value) {
+    input.time = std::chrono::nanoseconds{value};
+  });
+  readIntegers(reader, inputs, [](Input &input, std::int64_t value) {
+    input.tick = static_cast<std::uint64_t>(value);
+  });
+  for (auto &input : inputs) {
+    auto const type{static_cast<std::uint8_t>(reader.bytes(1))};
+    if (type > static_cast<std::uint8_t>(Simulation::Input::MultiBall))
+      throw std::runtime_error("Invalid input in telemetry");
+    input.input = static_cast<Simulation::Input>(type);
+  }
+}
+
+// O atraso de exibição é gravado somado de um, com zero para um atraso não
+// estimado
+void encodeStimuli(std::span<TelemetryStimulus const> stimuli,
+                   std::vector<std::uint8_t> &data) {
+  ByteWriter writer{data};
+  using Stimulus = TelemetryStimulus;
+  writeIntegers(writer, stimuli,
+                [](Stimulus const &stimulus) { return stimulus.time.count(); });
+  for (auto const &stimulus : stimuli) {
+    std::uint64_t delay{};
+    if (stimulus.displayDelay)
+      delay = static_cast<std::uint64_t>(stimulus.displayDelay->count()) + 1;
+    writer.varint(delay);
+  }
+}
+
+void decodeStimuli(ByteReader &reader,
+                   std::span<TelemetryStimulus> stimuli) {
+  using Stimulus = TelemetryStimulus;
+  readIntegers(reader, stimuli, [](Stimulus &stimulus, std::int64_t value) {
+    stimulus.time = std::chrono::nanoseconds{value};
+  });
+  for (auto &stimulus : stimuli) {
+    auto const delay{reader.varint()};
+    stimulus.displayDelay = std::nullopt;
+    if (delay > 0)
+      stimulus.displayDelay =
+          std::chrono::nanoseconds{static_cast<std::int64_t>(delay - 1)};
+  }
+}
+
+} // namespace
+
+TelemetryReader::TelemetryReader(std::span<std::uint8_t const> data)
+    : m_data{data} {
+  if (data.size() < telemetryMagic.size() ||
+      !std::equal(telemetryMagic.begin(), telemetryMagic.end(), data.begin()))
+    throw std::runtime_error("Not a telemetry file");
+
+  ByteReader reader{data.subspan(telemetryMagic.size()), "telemetry"};
+  auto const version{reader.bytes(2)};
+  if (version == 0 || version > telemetryVersion)
+    throw std::runtime_error("Unsupported telemetry version");
+
+  m_header.version = static_cast<std::uint16_t>(version);
+  m_header.tickRate = std::bit_cast<double>(reader.bytes(8));
+  // A versão 1 não tinha o início nem o paciente
+  if (version >= 2) {
+    m_header.startTime = std::chrono::milliseconds{
+        static_cast<std::int64_t>(reader.bytes(8))};
+    auto const patient{reader.span(reader.varint())};
+    m_header.patient.assign(patient.begin(), patient.end());
+  }
+  m_position = data.size() - reader.remaining();
+}
+
+// Sem o bloco final, o arquivo foi interrompido: lê até o último bloco
+// completo
+bool TelemetryReader::next(TelemetryLog &log) {
+  ByteReader reader{m_data.subspan(m_position), "telemetry"};
+  if (reader.remaining() == 0)
+    return false;
+
+  auto const type{static_cast<std::uint8_t>(reader.bytes(1))};
+  if (type == endBlock) {
+    log.droppedFrames = reader.varint();
+    log.droppedInputs = reader.varint();
+    if (m_header.version >= 3)
+      log.droppedStimuli = reader.varint();
+    log.complete = true;
+    m_position = m_data.size();
+    return false;
+  }
+
+  std::uint64_t count{};
+  std::uint64_t size{};
+  try {
+    count = reader.varint();
+    size = reader.varint();
+  } catch (std::runtime_error const &) {
+    return false;
+  }
+  if (size > reader.remaining())
+    return false;
+  // Cada registro ocupa ao menos um byte por coluna
+  if (count > size)
+    throw std::runtime_error("Invalid telemetry block");
+
+  ByteReader block{reader.span(size), "telemetry block"};
+  if (type == framesBlock) {
+    auto const first{log.frames.size()};
+    log.frames.resize(first + count);
+    decodeFrames(block, std::span{log.frames}.subspan(first));
+  } else if (type == inputsBlock) {
+    auto const first{log.inputs.size()};
+    log.inputs.resize(first + count);
+    decodeInputs(block, std::span{log.inputs}.subspan(first));
+  } else if (type == stimuliBlock && m_header.version >= 3) {
+    auto const first{log.stimuli.size()};
+    log.stimuli.resize(first + count);
+    decodeStimuli(block, std::span{log.stimuli}.subspan(first));
+  } else {
+    throw std::runtime_error("Invalid telemetry block");
+  }
+  m_position = m_data.size() - reader.remaining();
+  return true;
+}
+
+TelemetryLog TelemetryLog::decode(std::span<std::uint8_t const> data) {
+  TelemetryReader reader{data};
+  auto log{reader.getHeader()};
+  while (reader.next(log)) {
+  }
+  return log;
+}
+
+TelemetryLog TelemetryLog::load(std::string const &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Failed to open telemetry " + path);
+  std::vector<std::uint8_t> const data{std::istreambuf_iterator<char>(file),
+                                       std::istreambuf_iterator<char>()};
+  return decode(data);
+}
+
+TelemetryWriter::TelemetryWriter(std::string const &path, double tickRate,
+                                 std::string const &patient)
+    : m_path{path}, m_file{path, std::ios::binary} {
+  if (!m_file)
+    throw std::runtime_error("Failed to create telemetry " + path);
+
+  ByteWriter writer{m_header};
+  for (auto const byte : telemetryMagic) {
+    writer.bytes(byte, 1);
+  }
+  writer.bytes(telemetryVersion, 2);
+  writer.bytes(std::bit_cast<std::uint64_t>(tickRate), 8);
+  auto const startTime{std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch())};
+  writer.bytes(static_cast<std::uint64_t>(startTime.count()), 8);
+  writer.varint(patient.size());
+  for (auto const character : patient) {
+    writer.bytes(static_cast<std::uint8_t>(character), 1);
+  }
+  m_file.write(reinterpret_cast<char const *>(m_header.data()),
+               static_cast<std::streamsize>(m_header.size()));
+
+  m_frames.reserve(blockSize);
+  m_inputs.reserve(blockSize);
+  m_stimuli.reserve(blockSize);
+  m_thread = std::thread([this] { run(); });
+}
+
+TelemetryWriter::~TelemetryWriter() {
+  m_running.store(false, std::memory_order_release);
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+void TelemetryWriter::stop() {
+  m_running.store(false, std::memory_order_release);
+  if (m_thread.joinable())
+    m_thread.join();
+  if (m_failed)
+    throw std::runtime_error("Failed to write telemetry " + m_path);
+}
+
+bool TelemetryWriter::pushFrame(TelemetryFrame const &frame) noexcept {
+  if (m_frameQueue.push(frame))
+    return true;
+  m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+bool TelemetryWriter::pushInput(TelemetryInput const &input) noexcept {
+  if (m_inputQueue.push(input))
+    return true;
+  m_droppedInputs.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+bool TelemetryWriter::pushStimulus(
+    TelemetryStimulus const &stimulus) noexcept {
+  if (m_stimulusQueue.push(stimulus))
+    return true;
+  m_droppedStimuli.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+// O estado de m_running é lido antes de esvaziar as filas, de modo que o
+// último esvaziamento pega tudo o que foi enviado antes de stop
+void TelemetryWriter::run() {
+  while (true) {
+    auto const running{m_running.load(std::memory_order_acquire)};
+    drain();
+    if (!running)
+      break;
+    std::this_thread::sleep_for(drainInterval);
+  }
+
+  writeFrames();
+  writeInputs();
+  writeStimuli();
+  m_header.clear();
+  ByteWriter writer{m_header};
+  writer.bytes(endBlock, 1);
+  writer.varint(getDroppedFrames());
+  writer.varint(getDroppedInputs());
+  writer.varint(getDroppedStimuli());
+  m_file.write(reinterpret_cast<char const *>(m_header.data()),
+               static_cast<std::streamsize>(m_header.size()));
+  m_file.close();
+  if (!m_file)
+    m_failed = true;
+}
+
+void TelemetryWriter::drain() {
+  while (auto const frame{m_frameQueue.pop()}) {
+    m_frames.push_back(*frame);
+    if (m_frames.size() == blockSize)
+      writeFrames();
+  }
+  while (auto const input{m_inputQueue.pop()}) {
+    m_inputs.push_back(*input);
+    if (m_inputs.size() == blockSize)
+      writeInputs();
+  }
+  while (auto const stimulus{m_stimulusQueue.pop()}) {
+    m_stimuli.push_back(*stimulus);
+    if (m_stimuli.size() == blockSize)
+      writeStimuli();
+  }
+}
+
+void TelemetryWriter::writeFrames() {
+  if (m_frames.empty())
+    return;
+  encodeFrames(m_frames, m_buffer);
+  writeBlock(framesBlock, m_frames.size());
+  m_frames.clear();
+}
+
+void TelemetryWriter::writeInputs() {
+  if (m_inputs.empty())
+    return;
+  encodeInputs(m_inputs, m_buffer);
+  writeBlock(inputsBlock, m_inputs.size());
+  m_inputs.clear();
+}
+
+void TelemetryWriter::writeStimuli() {
+  if (m_stimuli.empty())
+    return;
+  encodeStimuli(m_stimuli, m_buffer);
+  writeBlock(stimuliBlock, m_stimuli.size());
+  m_stimuli.clear();
+}
+
+// Cada bloco vai para o disco assim que fica pronto, para que uma queda do
+// programa perca no máximo os registros ainda nas filas
+void TelemetryWriter::writeBlock(std::uint8_t type, std::size_t count) {
+  m_header.clear();
+  ByteWriter writer{m_header};
+  writer.bytes(type, 1);
+  writer.varint(count);
+  writer.varint(m_buffer.size());
+
+  m_file.write(reinterpret_cast<char const *>(m_header.data()),
+               static_cast<std::streamsize>(m_header.size()));
+  m_file.write(reinterpret_cast<char const *>(m_buffer.data()),
+               static_cast<std::streamsize>(m_buffer.size()));
+  m_file.flush();
+  if (!m_file)
+    m_failed = true;
+  m_buffer.clear();
+}
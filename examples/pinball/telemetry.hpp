@@ -0,0 +1,187 @@
+#ifndef TELEMETRY_HPP_
+#define TELEMETRY_HPP_
+
+#include "simulation.hpp"
+#include "spscqueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <glm/vec2.hpp>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Estado de um frame desenhado: o do último passo da física, e não a posição
+// interpolada em que a bola foi desenhada, de modo que ele coincide com o
+// estado da sessão reproduzida (SessionLog)
+struct TelemetryFrame {
+  // Instante do frame, desde o início da gravação
+  std::chrono::nanoseconds time{};
+  std::uint64_t tick{};
+  glm::vec2 ballPosition{};
+  glm::vec2 ballVelocity{};
+  float leftFlipperAngle{};
+  float rightFlipperAngle{};
+};
+
+// Entrada do jogador, aplicada no início do passo tick
+struct TelemetryInput {
+  // Instante em que o evento foi lido, desde o início da gravação
+  std::chrono::nanoseconds time{};
+  std::uint64_t tick{};
+  Simulation::Input input{};
+};
+
+// Estímulo detectado pelo jogo (a bola desenhada cruzando a zona de disparo),
+// gravado quando a exibição do seu frame é estimada ou abandonada
+struct TelemetryStimulus {
+  // Instante do frame do estímulo, desde o início da gravação
+  std::chrono::nanoseconds time{};
+  // Do frame até a sua exibição (ReactionTimer::Attempt::displayDelay);
+  // vazio se não foi estimada
+  std::optional<std::chrono::nanoseconds> displayDelay;
+};
+
+// Conteúdo de um arquivo de telemetria.
+//
+// O arquivo é uma sequência de blocos de até TelemetryWriter::blockSize
+// registros de um mesmo tipo, em colunas: todos os instantes do bloco, depois
+// todos os passos, depois todas as posições x da bola, e assim por diante.
+// Cada coluna é comprimida pela diferença para o registro anterior: segunda
+// diferença em varint para os instantes e passos, que crescem em ritmo quase
+// constante, e XOR com o valor anterior em varint para os floats, que
+// ocupam um byte enquanto não mudam (bola parada, flippers em repouso). A
+// compressão recomeça a cada bloco, e cada bloco traz o seu tamanho, de modo
+// que um arquivo interrompido (queda do programa) ainda é lido até o último
+// bloco completo.
+struct TelemetryLog {
+  // Versão do formato do arquivo; os estímulos existem a partir da 3
+  std::uint16_t version{};
+  double tickRate{};
+  // Início da gravação, desde a época de std::chrono::system_clock
+  std::chrono::milliseconds startTime{};
+  // Paciente da sessão (SessionSettings::patient), se houver
+  std::string patient;
+  std::vector<TelemetryFrame> frames;
+  std::vector<TelemetryInput> inputs;
+  std::vector<TelemetryStimulus> stimuli;
+  // Registros descartados porque a fila estava cheia
+  std::uint64_t droppedFrames{};
+  std::uint64_t droppedInputs{};
+  std::uint64_t droppedStimuli{};
+  // Se o arquivo foi fechado normalmente
+  bool complete{};
+
+  static TelemetryLog decode(std::span<std::uint8_t const> data);
+  static TelemetryLog load(std::string const &path);
+};
+
+// Lê um arquivo de telemetria bloco a bloco, com memória limitada a um bloco,
+// para arquivos grandes demais para TelemetryLog. data deve continuar válido
+// enquanto o leitor for usado
+class TelemetryReader {
+public:
+  // Lê o cabeçalho; em log, os vetores ficam vazios até next
+  explicit TelemetryReader(std::span<std::uint8_t const> data);
+
+  // Acrescenta os registros do próximo bloco a log.frames, log.inputs ou
+  // log.stimuli.
+  // Retorna false no fim do arquivo, ou depois do último bloco completo de
+  // um arquivo interrompido
+  bool next(TelemetryLog &log);
+
+  [[nodiscard]] TelemetryLog const &getHeader() const noexcept {
+    return m_header;
+  }
+
+private:
+  std::span<std::uint8_t const> m_data;
+  std::size_t m_position{};
+  TelemetryLog m_header;
+};
+
+// Grava a telemetria de uma sessão sem fazer E/S nas threads do jogo.
+//
+// pushFrame e pushInput apenas copiam o registro para filas sem travas
+// (SpscQueue) alocadas na construção; uma thread própria esvazia as filas a
+// cada drainInterval, comprime os blocos completos e os grava no arquivo.
+// Com uma fila cheia, o registro é descartado e contado, e o jogo nunca
+// espera. Cada fila tem um único produtor: os frames e os estímulos vêm da
+// thread da janela e as entradas, da thread que as aplica à simulação.
+class TelemetryWriter {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t blockSize{1024};
+  static constexpr std::chrono::milliseconds drainInterval{20};
+
+  // Cria o arquivo e inicia a thread de gravação
+  TelemetryWriter(std::string const &path, double tickRate,
+                  std::string const &patient = {});
+  ~TelemetryWriter();
+
+  TelemetryWriter(TelemetryWriter const &) = delete;
+  TelemetryWriter &operator=(TelemetryWriter const &) = delete;
+
+  // Grava os registros pendentes, fecha o arquivo e encerra a thread. Lança
+  // std::runtime_error se a gravação falhou
+  void stop();
+
+  // Tempo desde o início da gravação
+  [[nodiscard]] std::chrono::nanoseconds
+  since(Clock::time_point time) const noexcept {
+    return time - m_start;
+  }
+
+  // Retornam false se o registro foi descartado
+  bool pushFrame(TelemetryFrame const &frame) noexcept;
+  bool pushInput(TelemetryInput const &input) noexcept;
+  bool pushStimulus(TelemetryStimulus const &stimulus) noexcept;
+
+  [[nodiscard]] std::uint64_t getDroppedFrames() const noexcept {
+    return m_droppedFrames.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::uint64_t getDroppedInputs() const noexcept {
+    return m_droppedInputs.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] std::uint64_t getDroppedStimuli() const noexcept {
+    return m_droppedStimuli.load(std::memory_order_relaxed);
+  }
+
+private:
+  Clock::time_point m_start{Clock::now()};
+  std::string m_path;
+  std::ofstream m_file;
+
+  SpscQueue<TelemetryFrame, 8192> m_frameQueue;
+  SpscQueue<TelemetryInput, 1024> m_inputQueue;
+  SpscQueue<TelemetryStimulus, 256> m_stimulusQueue;
+  std::atomic<std::uint64_t> m_droppedFrames{0};
+  std::atomic<std::uint64_t> m_droppedInputs{0};
+  std::atomic<std::uint64_t> m_droppedStimuli{0};
+
+  // Usados só pela thread de gravação
+  std::vector<TelemetryFrame> m_frames;
+  std::vector<TelemetryInput> m_inputs;
+  std::vector<TelemetryStimulus> m_stimuli;
+  std::vector<std::uint8_t> m_header;
+  std::vector<std::uint8_t> m_buffer;
+  bool m_failed{false};
+
+  std::atomic<bool> m_running{true};
+  std::thread m_thread;
+
+  void run();
+  void drain();
+  void writeFrames();
+  void writeInputs();
+  void writeStimuli();
+  // Grava o bloco em m_buffer, precedido do tipo, do número de registros e
+  // do tamanho
+  void writeBlock(std::uint8_t type, std::size_t count);
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+  if (threadCount == 0)
+    threadCount = std::max(std::thread::hardware_concurrency(), 1U);
+
+  m_queues.reserve(threadCount);
+  for (unsigned i = 0; i < threadCount; ++i) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  m_threads.reserve(threadCount);
+  for (unsigned i = 0; i < threadCount; ++i) {
+    m_threads.emplace_back([this, i] { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock{m_mutex};
+    m_stopping = true;
+  }
+  m_workAvailable.notify_all();
+  for (auto &thread : m_threads) {
+    thread.join();
+  }
+}
+
+// Distribui as tarefas entre as filas em rodízio
+void ThreadPool::submit(Task task) {
+  auto const index{m_nextQueue.fetch_add(1, std::memory_order_relaxed) %
+                   m_queues.size()};
+  {
+    auto &queue{*m_queues[index]};
+    std::scoped_lock lock{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  m_pending.fetch_add(1);
+  m_queued.fetch_add(1);
+
+  // Trava o mutex antes de notificar para não perder o aviso de uma thread
+  // que acabou de verificar as filas e está prestes a dormir
+  { std::scoped_lock lock{m_mutex}; }
+  m_workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+  std::unique_lock lock{m_mutex};
+  m_allDone.wait(lock, [this] { return m_pending.load() == 0; });
+
+  if (m_exception) {
+    auto exception{std::exchange(m_exception, nullptr)};
+    std::rethrow_exception(exception);
+  }
+}
+
+// Retira uma tarefa do fim da própria fila ou rouba do início de outra
+bool ThreadPool::popTask(std::size_t index, Task &task) {
+  {
+    auto &queue{*m_queues[index]};
+    std::scoped_lock lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      m_queued.fetch_sub(1);
+      return true;
+    }
+  }
+
+  for (std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+    auto &queue{*m_queues[(index + offset) % m_queues.size()]};
+    std::scoped_lock lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      m_queued.fetch_sub(1);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+  while (true) {
+    if (Task task; popTask(index, task)) {
+      try {
+        task();
+      } catch (...) {
+        std::scoped_lock lock{m_mutex};
+        if (!m_exception)
+          m_exception = std::current_exception();
+      }
+
+      if (m_pending.fetch_sub(1) == 1) {
+        { std::scoped_lock lock{m_mutex}; }
+        m_allDone.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock lock{m_mutex};
+    m_workAvailable.wait(
+        lock, [this] { return m_stopping || m_queued.load() > 0; });
+    if (m_stopping && m_queued.load() == 0)
+      return;
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef THREADPOOL_HPP_
+#define THREADPOOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de threads com roubo de tarefas (work stealing).
+//
+// Cada thread tem sua própria fila: retira tarefas do fim da sua fila e,
+// quando ela esvazia, rouba do início da fila das outras. Assim as threads
+// que terminam antes (bolas que caem logo) continuam ocupadas sem disputar
+// uma única fila global.
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  // Com threadCount igual a zero, usa uma thread por núcleo
+  explicit ThreadPool(unsigned threadCount = 0);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const &) = delete;
+  ThreadPool &operator=(ThreadPool const &) = delete;
+
+  void submit(Task task);
+  // Espera todas as tarefas enviadas terminarem. Se alguma lançou uma
+  // exceção, a primeira delas é relançada aqui
+  void wait();
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_threads.size(); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_mutex;
+  std::condition_variable m_workAvailable;
+  std::condition_variable m_allDone;
+  // Tarefas nas filas e tarefas enviadas ainda não concluídas
+  std::atomic<std::size_t> m_queued{0};
+  std::atomic<std::size_t> m_pending{0};
+  std::atomic<std::size_t> m_nextQueue{0};
+  bool m_stopping{false};
+  std::exception_ptr m_exception;
+
+  void workerLoop(std::size_t index);
+  bool popTask(std::size_t index, Task &task);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#include "timestep.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Define a frequência da física, em passos por segundo
+void FixedTimestep::setTickRate(double tickRate) {
+  m_tickRate = std::max(tickRate, 1.0);
+  m_step = static_cast<float>(1.0 / m_tickRate);
+  reset();
+}
+
+// Define o número máximo de passos simulados em um único frame
+void FixedTimestep::setMaxSubsteps(int maxSubsteps) {
+  m_maxSubsteps = std::max(maxSubsteps, 1);
+}
+
+void FixedTimestep::reset() {
+  m_accumulator = 0.0;
+  m_alpha = 0.0f;
+}
+
+int FixedTimestep::advance(double frameTime) {
+  // Ignora tempos inválidos (por exemplo, relógio voltando no tempo)
+  if (!std::isfinite(frameTime) || frameTime < 0.0)
+    frameTime = 0.0;
+
+  m_accumulator += frameTime;
+
+  // Usa o passo em double para não acumular erro de arredondamento
+  auto const step{1.0 / m_tickRate};
+  auto steps{static_cast<int>(std::floor(m_accumulator / step))};
+
+  // Após um travamento longo, descarta o excesso em vez de tentar alcançar o
+  // tempo real, o que faria o custo do frame seguinte crescer sem limite
+  if (steps > m_maxSubsteps) {
+    m_droppedSteps += steps - m_maxSubsteps;
+    steps = m_maxSubsteps;
+    m_accumulator = steps * step;
+  }
+
+  m_accumulator -= steps * step;
+  m_alpha = static_cast<float>(std::clamp(m_accumulator / step, 0.0, 1.0));
+
+  return steps;
+}
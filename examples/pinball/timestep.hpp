@@ -0,0 +1,36 @@
+#ifndef TIMESTEP_HPP_
+#define TIMESTEP_HPP_
+
+// Passo de tempo fixo para a física do jogo.
+//
+// O tempo de cada frame é acumulado e consumido em passos de tamanho
+// constante (1/tickRate segundos). Assim o resultado das colisões não depende
+// da taxa de quadros da máquina, e o número de passos por frame é limitado por
+// maxSubsteps para que o custo da física continue limitado após travamentos.
+class FixedTimestep {
+public:
+  void setTickRate(double tickRate);
+  void setMaxSubsteps(int maxSubsteps);
+  void reset();
+
+  // Acumula o tempo do frame e retorna quantos passos devem ser simulados
+  [[nodiscard]] int advance(double frameTime);
+
+  [[nodiscard]] double getTickRate() const noexcept { return m_tickRate; }
+  [[nodiscard]] float getStep() const noexcept { return m_step; }
+  // Fração do próximo passo já acumulada, usada para interpolar a renderização
+  [[nodiscard]] float getAlpha() const noexcept { return m_alpha; }
+  // Número de passos descartados pelo limite de maxSubsteps
+  [[nodiscard]] long getDroppedSteps() const noexcept { return m_droppedSteps; }
+
+private:
+  double m_tickRate{1000.0};
+  float m_step{1.0f / 1000.0f};
+  int m_maxSubsteps{100};
+
+  double m_accumulator{};
+  float m_alpha{};
+  long m_droppedSteps{};
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef TRIPLEBUFFER_HPP_
+#define TRIPLEBUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+// Buffer triplo sem travas para um escritor e um leitor, em threads
+// diferentes.
+//
+// O escritor preenche o slot de trás e o publica; o leitor troca o seu slot
+// pelo mais recente publicado, se houver um novo. Os três slots nunca são
+// acessados pelas duas threads ao mesmo tempo, e nenhuma delas espera pela
+// outra: o escritor pode publicar várias vezes entre duas leituras (as
+// versões intermediárias são descartadas) e o leitor pode ler o mesmo slot
+// várias vezes. Os slots são reaproveitados, de modo que um T com vetores não
+// aloca memória depois que eles atingem o tamanho máximo.
+template <typename T> class TripleBuffer {
+public:
+  // Escritor: slot a preencher antes de publish()
+  [[nodiscard]] T &back() noexcept { return m_slots[m_back]; }
+
+  // Escritor: torna o slot de trás o estado mais recente
+  void publish() noexcept {
+    auto const previous{
+        m_middle.exchange(m_back | freshBit, std::memory_order_acq_rel)};
+    m_back = previous & indexMask;
+  }
+
+  // Leitor: passa para o estado mais recente, se um novo foi publicado desde
+  // a última chamada; retorna se houve troca
+  bool update() noexcept {
+    if ((m_middle.load(std::memory_order_relaxed) & freshBit) == 0)
+      return false;
+    auto const previous{
+        m_middle.exchange(m_front, std::memory_order_acq_rel)};
+    m_front = previous & indexMask;
+    return true;
+  }
+
+  // Leitor: estado obtido pelo último update()
+  [[nodiscard]] T const &front() const noexcept { return m_slots[m_front]; }
+
+private:
+  // O slot do meio é guardado com um bit que indica se ainda não foi lido
+  static constexpr std::uint8_t indexMask{0x3};
+  static constexpr std::uint8_t freshBit{0x4};
+
+  std::array<T, 3> m_slots{};
+  // Índices separados em linhas de cache diferentes, pois cada um é usado
+  // por uma thread
+  alignas(64) std::atomic<std::uint8_t> m_middle{1};
+  alignas(64) std::uint8_t m_back{0};
+  alignas(64) std::uint8_t m_front{2};
+};
+
+#endif
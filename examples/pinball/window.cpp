@@ -1,21 +1,26 @@
 #include "window.hpp"
-#include "gamedata.hpp"
 #include "render.hpp"
+#include <algorithm>
+#include <chrono>
+#include <glm/common.hpp>
 #include <random>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/rotate_vector.hpp>
 
 // Função chamada quando a janela é criada
 void Window::onCreate() {
   // Shader de vértice que lida com a posição, translação, escala e rotação dos
-  // objetos
+  // objetos. Os dados de cada objeto vêm de um bloco de uniforms (std140),
+  // escolhido por DrawList::flush com glBindBufferRange
   auto const *vertexShader =
       R"gl(
     #version 300 es
     layout(location = 0) in vec2 inPosition;
-    uniform vec2 translate;
-    uniform float scale;
-    uniform float rotate;
+    layout(std140) uniform Object {
+      vec4 color;
+      vec2 translate;
+      float scale;
+      float rotate;
+    };
+    out vec4 fragColor;
     void main() {
       vec2 pos = inPosition;
       // Calcula a rotação usando matriz de rotação 2D
@@ -28,6 +33,7 @@ void Window::onCreate() {
       // Aplica escala e translação
       vec2 finalPos = rotPos * scale + translate;
       gl_Position = vec4(finalPos, 0, 1);
+      fragColor = color;
     }
   )gl";
 
@@ -36,28 +42,98 @@ void Window::onCreate() {
       R"gl(
     #version 300 es
     precision mediump float;
-    uniform vec4 color;
+    in vec4 fragColor;
     out vec4 outColor;
-    void main() { outColor = color; }
+    void main() { outColor = fragColor; }
   )gl";
 
-  // Configuração do gerador de números aleatórios
-  std::random_device rd;
-  std::mt19937 gen(rd());
-
-  // Distribuições para posições e tamanhos aleatórios dos obstáculos
-  std::uniform_real_distribution<float> distPosX(WALL_LEFT + 0.2f,
-                                                 WALL_RIGHT - 0.2f);
-  std::uniform_real_distribution<float> distPosY(-0.2f, WALL_TOP - 0.2f);
-  std::uniform_real_distribution<float> distRadius(0.1f, 0.3f);
-
-  // Criação dos obstáculos com posições e raios aleatórios
-  int numObstacles = 6;
-  m_obstacles.clear();
-  for (int i = 0; i < numObstacles; ++i) {
-    glm::vec2 randomPosition(distPosX(gen), distPosY(gen));
-    float randomRadius = distRadius(gen);
-    m_obstacles.push_back({randomPosition, randomRadius});
+  // Shaders dos círculos instanciados: centro, raio e cor vêm de atributos
+  // por instância, e não de uniforms. Cada círculo é um quadrado; o shader de
+  // fragmento calcula a distância ao centro (um campo de distância com sinal)
+  // e suaviza a borda ao longo de um pixel, sem depender de MSAA
+  auto const *circleVertexShader =
+      R"gl(
+    #version 300 es
+    layout(location = 0) in vec2 inPosition;
+    layout(location = 1) in vec2 inCenter;
+    layout(location = 2) in float inRadius;
+    layout(location = 3) in vec4 inColor;
+    out vec2 fragLocal;
+    out vec4 fragColor;
+    void main() {
+      fragLocal = inPosition;
+      fragColor = inColor;
+      gl_Position = vec4(inPosition * inRadius + inCenter, 0, 1);
+    }
+  )gl";
+
+  auto const *circleFragmentShader =
+      R"gl(
+    #version 300 es
+    precision mediump float;
+    in vec2 fragLocal;
+    in vec4 fragColor;
+    out vec4 outColor;
+    void main() {
+      // Distância ao centro em raios; fwidth é o quanto ela varia em um pixel
+      float centerDistance = length(fragLocal);
+      float edgeWidth = fwidth(centerDistance);
+      float coverage =
+        1.0 - smoothstep(1.0 - edgeWidth, 1.0, centerDistance);
+      if (coverage <= 0.0) discard;
+      outColor = vec4(fragColor.rgb, fragColor.a * coverage);
+    }
+  )gl";
+
+  // Shaders da cópia da camada estática: o quadrado cobre a tela inteira e
+  // cada pixel lê o texel correspondente da textura da camada
+  auto const *layerVertexShader =
+      R"gl(
+    #version 300 es
+    layout(location = 0) in vec2 inPosition;
+    out vec2 fragTexCoord;
+    void main() {
+      fragTexCoord = inPosition * 0.5 + 0.5;
+      gl_Position = vec4(inPosition, 0, 1);
+    }
+  )gl";
+
+  auto const *layerFragmentShader =
+      R"gl(
+    #version 300 es
+    precision mediump float;
+    uniform sampler2D layer;
+    in vec2 fragTexCoord;
+    out vec4 outColor;
+    void main() { outColor = vec4(texture(layer, fragTexCoord).rgb, 1.0); }
+  )gl";
+
+  // Mesa descrita em assets/table.txt
+  m_simulation.setTable(
+      Table::load(abcg::Application::getAssetsPath() + "table.txt"));
+  // A frequência é gravada na sessão; na reprodução, vale a da sessão
+  if (m_tickRate)
+    m_simulation.getTimestep().setTickRate(*m_tickRate);
+
+  // Layout aleatório de obstáculos, ou o layout da sessão reproduzida. A
+  // semente e todas as entradas são registradas para reproduzir a sessão
+  if (m_sessionSettings.replayPath.empty()) {
+    std::random_device rd;
+    m_simulation.generateObstacles(rd());
+    m_session = SessionLog::begin(m_simulation);
+  } else {
+    m_player.emplace(SessionLog::load(m_sessionSettings.replayPath));
+    m_player->start(m_simulation);
+  }
+
+  m_triggerZone = TriggerZone::fromTable(m_simulation.getTable());
+  m_sessionStart = SessionStore::now();
+  loadHistory();
+
+  if (!m_sessionSettings.telemetryPath.empty()) {
+    m_telemetry = std::make_unique<TelemetryWriter>(
+        m_sessionSettings.telemetryPath,
+        m_simulation.getTimestep().getTickRate(), m_sessionSettings.patient);
   }
 
   // Cria o programa OpenGL combinando os shaders
@@ -65,267 +141,411 @@ void Window::onCreate() {
       {{.source = vertexShader, .stage = abcg::ShaderStage::Vertex},
        {.source = fragmentShader, .stage = abcg::ShaderStage::Fragment}});
 
-  // Obtém as localizações das variáveis uniformes dos shaders
-  m_colorLoc = glGetUniformLocation(m_program, "color");
-  m_translateLoc = glGetUniformLocation(m_program, "translate");
-  m_scaleLoc = glGetUniformLocation(m_program, "scale");
-  m_rotateLoc = glGetUniformLocation(m_program, "rotate");
+  // Liga o bloco de uniforms dos objetos ao ponto usado pela DrawList
+  glUniformBlockBinding(m_program, glGetUniformBlockIndex(m_program, "Object"),
+                        DrawList::objectBinding);
 
-  // Cria e configura o Vertex Array Object
-  glGenVertexArrays(1, &m_VAO);
-  glBindVertexArray(m_VAO);
+  m_circleProgram = abcg::createOpenGLProgram(
+      {{.source = circleVertexShader, .stage = abcg::ShaderStage::Vertex},
+       {.source = circleFragmentShader,
+        .stage = abcg::ShaderStage::Fragment}});
 
-  // Configura a bola e os flippers
-  setupBall();
-  setupFlippers();
+  m_layerProgram = abcg::createOpenGLProgram(
+      {{.source = layerVertexShader, .stage = abcg::ShaderStage::Vertex},
+       {.source = layerFragmentShader, .stage = abcg::ShaderStage::Fragment}});
+  glUseProgram(m_layerProgram);
+  glUniform1i(glGetUniformLocation(m_layerProgram, "layer"), 0);
+  glUseProgram(0);
+
+  // Envia toda a geometria para a GPU; por frame, só os uniforms mudam
+  Render::createMeshes(*this);
+  m_drawList.create();
+
+  // As colisões da bola geram partículas, que caem e perdem velocidade
+  m_simulation.setCollisionEventsEnabled(true);
+  m_particles.create({.gravity = {0.0f, -1.5f}, .drag = 2.0f});
 
   // Define a cor de fundo e a largura das linhas
   glClearColor(0.2f, 0.2f, 0.2f, 1.0f);
   glLineWidth(10.0f);
-}
 
-// Verifica colisões entre a bola e os obstáculos
-void Window::checkCollisionWithObstacles() {
-  float scaledBallRadius = m_ball.radius * m_gameScale;
-
-  for (auto const &obstacle : m_obstacles) {
-    // Calcula a distância entre o centro da bola e o centro do obstáculo
-    float distance = glm::length(m_ball.position - obstacle.position);
-
-    // Verifica se há sobreposição entre a bola e o obstáculo
-    if (distance < (scaledBallRadius + obstacle.radius / 2.5)) {
-      // Calcula a reflexão da velocidade da bola usando o vetor normal
-      glm::vec2 normal = glm::normalize(m_ball.position - obstacle.position);
-      m_ball.velocity = glm::reflect(m_ball.velocity, normal);
-    }
+  // A partir daqui, a simulação (e a sessão) pertencem à thread
+  if (m_threadedSimulation) {
+    m_simulationThread = std::make_unique<SimulationThread>(
+        m_simulation,
+        [this](Simulation &simulation, double elapsed) {
+          advanceSimulation(simulation, elapsed);
+        },
+        [this](Simulation &simulation, Simulation::Input input,
+               std::uint32_t timestamp,
+               SimulationSnapshot::Clock::time_point time) {
+          recordInput(simulation, input, timestamp, time);
+        });
+    m_simulationThread->start();
   }
 }
 
-// Configura a posição inicial da bola
-void Window::setupBall() {
-  m_ball.position = {1.1f, 0.8f}; // Posição inicial fora da área de jogo
-  m_ball.velocity = {0.0f, 0.0f}; // Velocidade inicial zero
-  m_ball.radius = 0.20f;
-}
-
-// Configura a posição e ângulos iniciais dos flippers
-void Window::setupFlippers() {
-  // Flipper esquerdo
-  m_leftFlipper.position = {-0.5f, -0.8f};
-  m_leftFlipper.currentAngle = -0.3f;
-  m_leftFlipper.targetAngle = -0.3f;
-  m_leftFlipper.length = 0.4f;
-
-  // Flipper direito
-  m_rightFlipper.position = {0.5f, -0.8f};
-  m_rightFlipper.currentAngle = -0.3f;
-  m_rightFlipper.targetAngle = -0.3f;
-  m_rightFlipper.length = 0.4f;
-}
-
 // Atualiza o estado do jogo a cada frame
 void Window::onUpdate() {
-  if (!m_gameStarted)
-    return;
+  if (!m_simulationThread)
+    advanceSimulation(m_simulation, getDeltaTime());
+}
 
-  auto const deltaTime{getDeltaTime()};
-  if (deltaTime <= std::numeric_limits<float>::epsilon())
+void Window::advanceSimulation(Simulation &simulation, double elapsed) {
+  if (!m_player) {
+    simulation.update(elapsed);
     return;
+  }
 
-  // Configurações de velocidade angular dos flippers
-  float maxAngularSpeed = 5.0f;
-  float maxAngularVelocity = 5.0f;
-
-  // Lambda function para atualizar os ângulos dos flippers
-  auto updateFlipperAngle = [&](Flipper &flipper) {
-    float previousAngle = flipper.currentAngle;
-    float angleDifference = flipper.targetAngle - flipper.currentAngle;
-    float angleStep = maxAngularSpeed * deltaTime;
-
-    // Atualiza o ângulo atual
-    if (std::abs(angleDifference) < angleStep) {
-      flipper.currentAngle = flipper.targetAngle;
-    } else {
-      flipper.currentAngle += (angleDifference > 0 ? angleStep : -angleStep);
-    }
-
-    // Calcula e limita a velocidade angular
-    if (deltaTime > std::numeric_limits<float>::epsilon()) {
-      flipper.angularVelocity =
-          (flipper.currentAngle - previousAngle) / deltaTime;
-      flipper.angularVelocity = std::clamp(
-          flipper.angularVelocity, -maxAngularVelocity, maxAngularVelocity);
-    } else {
-      flipper.angularVelocity = 0.0f;
-    }
-  };
-
-  // Atualiza ambos os flippers
-  updateFlipperAngle(m_leftFlipper);
-  updateFlipperAngle(m_rightFlipper);
-
-  // Aplica gravidade à bola
-  m_ball.velocity.y -= 0.8f * deltaTime;
+  // Reprodução em tempo real: o relógio define quantos passos simular, e as
+  // entradas vêm da sessão gravada
+  auto const steps{simulation.getTimestep().advance(elapsed)};
+  m_player->advance(simulation, static_cast<std::uint64_t>(steps));
+}
 
-  // Verifica se a velocidade da bola é válida
-  if (glm::any(glm::isnan(m_ball.velocity)) ||
-      glm::any(glm::isinf(m_ball.velocity))) {
-    m_ball.velocity = glm::vec2(0.0f);
+// Envia a entrada para a simulação: pela fila da thread da simulação, se
+// houver uma, com o instante em que o evento foi lido, ou diretamente
+void Window::applyInput(Simulation::Input input, std::uint32_t timestamp) {
+  if (!m_simulationThread) {
+    recordInput(m_simulation, input, timestamp, getEventTime());
+    return;
   }
+  if (!m_simulationThread->pushInput(input, timestamp, getEventTime()))
+    fmt::print(stderr, "Input queue full, input dropped\n");
+}
 
-  // Atualiza a posição da bola e verifica colisões
-  m_ball.position += m_ball.velocity * static_cast<float>(deltaTime);
-  checkCollisions();
-  checkCollisionWithObstacles();
+// Registra a entrada na sessão e na telemetria e a aplica à simulação
+void Window::recordInput(Simulation &simulation, Simulation::Input input,
+                         std::uint32_t timestamp,
+                         SimulationSnapshot::Clock::time_point time) {
+  m_session.record(simulation, input, timestamp);
+  if (m_telemetry) {
+    m_telemetry->pushInput({.time = m_telemetry->since(time),
+                            .tick = simulation.getTick(),
+                            .input = input});
+  }
+  simulation.handleInput(input);
 }
 
 // Manipula eventos de entrada
 void Window::onEvent(SDL_Event const &event) {
+  using Input = Simulation::Input;
+
+  // Durante a reprodução, o teclado não controla o jogo
+  if (m_player)
+    return;
+
+  auto const timestamp{event.key.timestamp};
   if (event.type == SDL_KEYDOWN) {
+    // A primeira pressão de um flipper é a resposta ao estímulo; a
+    // repetição automática do teclado não conta
+    if ((event.key.keysym.sym == SDLK_LEFT ||
+         event.key.keysym.sym == SDLK_RIGHT) &&
+        event.key.repeat == 0)
+      recordResponse(getEventTime());
     // Inicia o jogo com a tecla espaço
-    if (event.key.keysym.sym == SDLK_SPACE && !m_gameStarted) {
-      m_gameStarted = true;
-      m_ball.velocity = {2.0f, 0.5f};
-    }
+    if (event.key.keysym.sym == SDLK_SPACE)
+      applyInput(Input::Launch, timestamp);
+    // Inicia uma rodada multibola com a tecla M
+    if (event.key.keysym.sym == SDLK_m)
+      applyInput(Input::MultiBall, timestamp);
     // Controle dos flippers
     if (event.key.keysym.sym == SDLK_LEFT)
-      m_leftFlipper.targetAngle = 0.8f;
+      applyInput(Input::LeftFlipperDown, timestamp);
     if (event.key.keysym.sym == SDLK_RIGHT)
-      m_rightFlipper.targetAngle = 0.8f;
+      applyInput(Input::RightFlipperDown, timestamp);
   }
   // Reset dos flippers quando as teclas são soltas
   else if (event.type == SDL_KEYUP) {
     if (event.key.keysym.sym == SDLK_LEFT)
-      m_leftFlipper.targetAngle = -0.5f;
+      applyInput(Input::LeftFlipperUp, timestamp);
     if (event.key.keysym.sym == SDLK_RIGHT)
-      m_rightFlipper.targetAngle = -0.5f;
+      applyInput(Input::RightFlipperUp, timestamp);
   }
 }
 
-// Sistema de colisões
-void Window::checkCollisions() {
-  const float flipperHalfHeight = 0.025f;
-
-  // Lambda function para verificar colisão entre bola e flipper
-  auto checkBallFlipperCollision = [&](Ball &ball, Flipper const &flipper,
-                                       bool isLeft) {
-    glm::vec2 relPos = ball.position - flipper.position;
-    float angle = isLeft ? flipper.currentAngle : -flipper.currentAngle;
-    glm::vec2 rotatedPos = glm::rotate(relPos, -angle);
-
-    float xMin = isLeft ? 0.0f : -flipper.length;
-    float xMax = isLeft ? flipper.length : 0.0f;
-
-    // Verifica se há colisão
-    if (rotatedPos.x >= xMin && rotatedPos.x <= xMax &&
-        rotatedPos.y >= -flipperHalfHeight &&
-        rotatedPos.y <= flipperHalfHeight) {
-
-      // Calcula a nova velocidade após a colisão
-      glm::vec2 normal = glm::rotate(glm::vec2(0.0f, 1.0f), angle);
-      glm::vec2 flipperVelocity =
-          flipper.angularVelocity * glm::vec2(-relPos.y, relPos.x);
-
-      // Limita a velocidade do flipper
-      float maxFlipperSpeed = 2.0f;
-      if (glm::length(flipperVelocity) > maxFlipperSpeed) {
-        flipperVelocity = glm::normalize(flipperVelocity) * maxFlipperSpeed;
-      }
-
-      // Calcula e aplica a nova velocidade da bola
-      glm::vec2 relativeVelocity = ball.velocity - flipperVelocity;
-      glm::vec2 newVelocity =
-          glm::reflect(relativeVelocity, normal) + flipperVelocity;
-
-      if (!glm::any(glm::isnan(newVelocity)) &&
-          !glm::any(glm::isinf(newVelocity))) {
-        ball.velocity = newVelocity;
-      }
-    }
-  };
+// Escolhe o estado a desenhar neste frame e o instante entre os dois últimos
+// passos em que ele é desenhado
+void Window::updateFrame() {
+  if (m_simulationThread) {
+    m_frame = &m_simulationThread->latest();
+  } else {
+    m_localFrame.capture(m_simulation);
+    m_frame = &m_localFrame;
+  }
+  auto const now{SimulationSnapshot::Clock::now()};
+  m_frameInterpolation = m_frame->interpolation(now);
 
-  // Verifica colisões com ambos os flippers
-  checkBallFlipperCollision(m_ball, m_leftFlipper, true);
-  checkBallFlipperCollision(m_ball, m_rightFlipper, false);
+  collectCollisionEvents();
+  resolveStimulusDisplay();
+  detectStimulus(now);
+  recordTelemetryFrame(now);
+}
 
-  // Verifica colisões com as paredes
-  checkWallCollision();
-  checkBottomWallCollision();
+// Estado do último passo, e não o interpolado: com o passo, ele é o mesmo
+// estado da sessão reproduzida
+void Window::recordTelemetryFrame(SimulationSnapshot::Clock::time_point now) {
+  if (!m_telemetry)
+    return;
+  m_telemetry->pushFrame(
+      {.time = m_telemetry->since(now),
+       .tick = m_frame->tick,
+       .ballPosition = m_frame->ball.position,
+       .ballVelocity = m_frame->ball.velocity,
+       .leftFlipperAngle = m_frame->leftFlipper.currentAngle,
+       .rightFlipperAngle = m_frame->rightFlipper.currentAngle});
+}
 
-  // Reset da bola se ela cair muito abaixo
-  float scaledBallRadius = m_ball.radius * m_gameScale;
-  if ((m_ball.position.y - scaledBallRadius) < WALL_BOTTOM) {
-    setupBall();
-    m_gameStarted = false;
+// Grava o que resta nas filas e fecha o arquivo de telemetria
+void Window::stopTelemetry() {
+  recordPendingStimulus();
+  if (!m_telemetry)
+    return;
+  try {
+    m_telemetry->stop();
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
   }
+  if (auto const dropped{m_telemetry->getDroppedFrames()}; dropped > 0)
+    fmt::print(stderr, "Telemetry: {} frames dropped\n", dropped);
+  if (auto const dropped{m_telemetry->getDroppedInputs()}; dropped > 0)
+    fmt::print(stderr, "Telemetry: {} inputs dropped\n", dropped);
+  if (auto const dropped{m_telemetry->getDroppedStimuli()}; dropped > 0)
+    fmt::print(stderr, "Telemetry: {} stimuli dropped\n", dropped);
+  m_telemetry.reset();
 }
 
-// Verifica colisões com as paredes laterais e superior
-void Window::checkWallCollision() {
-  float scaledBallRadius = m_ball.radius * m_gameScale;
+// O estímulo é o primeiro frame em que a bola aparece abaixo da linha de
+// disparo, e não o passo da física em que ela a cruzou: o jogador reage ao
+// que vê
+void Window::detectStimulus(SimulationSnapshot::Clock::time_point now) {
+  auto const &ball{m_frame->ball};
+  auto const drawn{
+      glm::mix(ball.previousPosition, ball.position, m_frameInterpolation)};
+  if (m_triggerZone.crossed(m_lastDrawnBall, drawn)) {
+    recordPendingStimulus();
+    m_reactionTimer.stimulus(now);
+    m_pendingStimulus = {.attempt = m_reactionTimer.getAttempts().size() - 1,
+                         .frame = getFrameTimer().getFrameNumber()};
+  }
+  m_lastDrawnBall = drawn;
+  m_reactionTimer.expire(now);
+}
 
-  // Colisão com parede esquerda
-  if ((m_ball.position.x - scaledBallRadius) < (WALL_LEFT + 0.1f)) {
-    m_ball.position.x = (WALL_LEFT + 0.1f) + scaledBallRadius;
-    m_ball.velocity.x *= -0.8f;
+// O instante de exibição do frame do estímulo só é conhecido alguns frames
+// depois, quando a GPU termina de desenhá-lo. Um novo estímulo antes disso
+// substitui o pendente
+void Window::resolveStimulusDisplay() {
+  if (!m_pendingStimulus)
+    return;
+  auto const &timer{getFrameTimer()};
+  if (auto const timing{timer.getTiming(m_pendingStimulus->frame)}) {
+    m_reactionTimer.presented(m_pendingStimulus->attempt, timing->displayed);
+    recordPendingStimulus();
+  } else if (timer.getFrameNumber() >
+             m_pendingStimulus->frame + abcg::OpenGLFrameTimer::historySize) {
+    // Frame perdido pelo timer: a tentativa fica sem correção
+    recordPendingStimulus();
   }
+}
+
+// O pinball_analytics refaz as tentativas com estes estímulos, e não com a
+// trajetória gravada, que não é a posição desenhada
+void Window::recordPendingStimulus() {
+  if (!m_pendingStimulus)
+    return;
+  auto const &attempt{
+      m_reactionTimer.getAttempts().at(m_pendingStimulus->attempt)};
+  m_pendingStimulus.reset();
+  if (!m_telemetry)
+    return;
+  m_telemetry->pushStimulus(
+      {.time = m_telemetry->since(attempt.stimulus),
+       .displayDelay = attempt.displayDelay});
+}
 
-  // Colisão com parede direita
-  if ((m_ball.position.x + scaledBallRadius) > (WALL_RIGHT - 0.1f)) {
-    m_ball.position.x = (WALL_RIGHT - 0.1f) - scaledBallRadius;
-    m_ball.velocity.x *= -0.8f;
+void Window::recordResponse(SimulationSnapshot::Clock::time_point time) {
+  if (!m_reactionTimer.respond(time))
+    return;
+  // Em geral, o frame do estímulo já foi exibido muito antes da resposta
+  auto const &attempt{m_reactionTimer.getAttempts().back()};
+  auto const latency{attempt.displayLatency()};
+  if (!latency)
+    return;
+  fmt::print("Reaction time: {:.3f} ms{}\n",
+             std::chrono::duration<double, std::milli>(*latency).count(),
+             attempt.displayDelay ? " (from display)" : "");
+}
+
+void Window::printReactionSummary() const {
+  auto const summary{m_reactionTimer.summarize()};
+  if (summary.attempts == 0)
+    return;
+
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  fmt::print("Reaction time: {} of {} attempts answered", summary.responses,
+             summary.attempts);
+  if (summary.responses > 0) {
+    fmt::print(", mean {:.3f} ms, median {:.3f} ms, min {:.3f} ms, "
+               "max {:.3f} ms",
+               Milliseconds(summary.mean).count(),
+               Milliseconds(summary.median).count(),
+               Milliseconds(summary.min).count(),
+               Milliseconds(summary.max).count());
+    if (summary.corrected > 0)
+      fmt::print(" (from display, {} of {} corrected by {:.3f} ms on "
+                 "average)",
+                 summary.corrected, summary.responses,
+                 Milliseconds(summary.meanDisplayDelay).count());
+  }
+  fmt::print("\n");
+}
+
+// Histórico aberto só para a consulta: o mapeamento do arquivo é desfeito
+// ao sair
+void Window::loadHistory() {
+  if (m_sessionSettings.patient.empty())
+    return;
+  try {
+    SessionStore const store{m_sessionSettings.storePath};
+    m_history = store.query(m_sessionSettings.patient,
+                            m_sessionStart - historyPeriod, m_sessionStart);
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
   }
 
-  // Colisão com parede superior
-  if ((m_ball.position.y + scaledBallRadius) > WALL_TOP) {
-    m_ball.position.y = WALL_TOP - scaledBallRadius;
-    m_ball.velocity.y *= -0.8f;
+  using Milliseconds = std::chrono::duration<float, std::milli>;
+  for (auto const &record : m_history) {
+    if (record.responses > 0)
+      m_historyMedians.push_back(Milliseconds(record.medianLatency).count());
   }
 }
 
-// Verifica colisões com as paredes inferiores
-void Window::checkBottomWallCollision() {
-  float scaledBallRadius = m_ball.radius * m_gameScale;
+// Acrescenta a sessão ao histórico do paciente, se houve alguma tentativa
+void Window::saveSession() {
+  auto const summary{m_reactionTimer.summarize()};
+  if (m_sessionSettings.patient.empty() || summary.attempts == 0)
+    return;
 
-  // Colisão com parede inferior esquerda
-  if ((m_ball.position.y - scaledBallRadius) < (WALL_BOTTOM + 0.2f) &&
-      (m_ball.position.x - scaledBallRadius) < (m_leftFlipper.position.x)) {
-    m_ball.position.y = WALL_BOTTOM + 0.2f + scaledBallRadius;
-    m_ball.velocity.y *= -0.8f;
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  SessionRecord const record{
+      .startTime = m_sessionStart,
+      .duration = SessionStore::now() - m_sessionStart,
+      .attempts = static_cast<std::uint32_t>(summary.attempts),
+      .responses = static_cast<std::uint32_t>(summary.responses),
+      .meanLatency = duration_cast<microseconds>(summary.mean),
+      .medianLatency = duration_cast<microseconds>(summary.median),
+      .minLatency = duration_cast<microseconds>(summary.min),
+      .maxLatency = duration_cast<microseconds>(summary.max)};
+  try {
+    SessionStore store{m_sessionSettings.storePath};
+    store.append(m_sessionSettings.patient, record);
+  } catch (std::exception const &exception) {
+    fmt::print(stderr, "{}\n", exception.what());
   }
+}
 
-  // Colisão com parede inferior direita
-  if ((m_ball.position.y - scaledBallRadius) < (WALL_BOTTOM + 0.2f) &&
-      (m_ball.position.x + scaledBallRadius) > (m_rightFlipper.position.x)) {
-    m_ball.position.y = WALL_BOTTOM + 0.2f + scaledBallRadius;
-    m_ball.velocity.y *= -0.8f;
+// Transforma as colisões desde o último frame em partículas
+void Window::collectCollisionEvents() {
+  if (m_simulationThread) {
+    while (auto const event{m_simulationThread->popCollisionEvent()})
+      Render::emitParticles(*this, *event);
+    return;
   }
+  for (auto const &event : m_simulation.getCollisionEvents())
+    Render::emitParticles(*this, event);
+  m_simulation.clearCollisionEvents();
 }
 
 // Renderiza os elementos do jogo
 void Window::onPaint() {
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glUseProgram(m_program);
+  updateFrame();
 
-  glUniform1f(m_scaleLoc, m_gameScale);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Renderiza todos os elementos do jogo
-  Render::renderWalls(*this);
-  Render::renderBall(*this);
-  Render::renderFlipper(*this, m_leftFlipper, true);
-  Render::renderFlipper(*this, m_rightFlipper, false);
+  // Fundo, mesa e obstáculos, que não se movem, vêm da camada estática; por
+  // cima dela são desenhados os flippers e as bolas (uma única chamada de
+  // desenho para todas as bolas), gravados na lista de desenho e executados
+  // juntos
+  Render::renderStaticLayer(*this);
 
-  for (auto const &obstacle : m_obstacles) {
-    Render::renderObstacles(*this, obstacle.position, obstacle.radius);
-  }
+  Render::renderFlipper(*this, m_frame->leftFlipper, true);
+  Render::renderFlipper(*this, m_frame->rightFlipper, false);
+  Render::renderBalls(*this);
+  m_drawList.flush();
+  Render::renderParticles(*this, static_cast<float>(getDeltaTime()));
 
   glBindVertexArray(0);
   glUseProgram(0);
 }
 
+// Janela de progresso do paciente: a mediana do tempo de reação das sessões
+// do período e o resumo da sessão atual
+void Window::onPaintUI() {
+  abcg::OpenGLWindow::onPaintUI();
+  if (m_sessionSettings.patient.empty())
+    return;
+
+  auto const width{220.0f};
+  ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - width - 5, 5));
+  ImGui::SetNextWindowSize(ImVec2(width, 0));
+  ImGui::Begin("Progress", nullptr,
+               ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
+                   ImGuiWindowFlags_NoBringToFrontOnFocus |
+                   ImGuiWindowFlags_NoFocusOnAppearing);
+  ImGui::Text("Patient: %s", m_sessionSettings.patient.c_str());
+  ImGui::Text("Last %d days: %zu sessions",
+              static_cast<int>(historyPeriod.count()), m_history.size());
+  if (!m_historyMedians.empty()) {
+    auto const maxMedian{*std::max_element(m_historyMedians.begin(),
+                                           m_historyMedians.end())};
+    ImGui::PlotLines("##median", m_historyMedians.data(),
+                     static_cast<int>(m_historyMedians.size()), 0,
+                     "median (ms)", 0.0f, maxMedian * 1.2f,
+                     ImVec2(width - 16, 50));
+  }
+
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+  auto const summary{m_reactionTimer.summarize()};
+  ImGui::Text("This session: %zu of %zu answered", summary.responses,
+              summary.attempts);
+  if (summary.responses > 0)
+    ImGui::Text("Median: %.0f ms", Milliseconds(summary.median).count());
+  ImGui::End();
+}
+
+// A camada estática é refeita com o novo tamanho no próximo frame
+void Window::onResize(glm::ivec2 const &size) {
+  m_viewportSize = size;
+  glViewport(0, 0, size.x, size.y);
+}
+
 void Window::onDestroy() {
-  if (m_VAO != 0)
-    glDeleteVertexArrays(1, &m_VAO);
+  // Para a thread antes de acessar a simulação e a sessão
+  m_simulationThread.reset();
+
+  stopTelemetry();
+  printReactionSummary();
+  saveSession();
+
+  // Grava a sessão; uma falha aqui não deve impedir a liberação dos recursos
+  if (!m_player && !m_sessionSettings.recordPath.empty()) {
+    try {
+      m_session.finish(m_simulation);
+      m_session.save(m_sessionSettings.recordPath);
+    } catch (std::exception const &exception) {
+      fmt::print(stderr, "{}\n", exception.what());
+    }
+  }
+
+  Render::destroyMeshes(*this);
+  m_drawList.destroy();
+  m_particles.destroy();
   if (m_program != 0)
     glDeleteProgram(m_program);
+  if (m_circleProgram != 0)
+    glDeleteProgram(m_circleProgram);
+  if (m_layerProgram != 0)
+    glDeleteProgram(m_layerProgram);
 }
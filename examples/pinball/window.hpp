@@ -3,46 +3,157 @@
 
 #include "abcg.hpp"
 #include "abcgOpenGL.hpp"
+#include "drawlist.hpp"
 #include "gamedata.hpp"
-#include <random>
+#include "mesh.hpp"
+#include "reactiontimer.hpp"
+#include "sessionlog.hpp"
+#include "sessionstore.hpp"
+#include "simthread.hpp"
+#include "simulation.hpp"
+#include "staticlayer.hpp"
+#include "telemetry.hpp"
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
+// Gravação e reprodução de sessões (SessionLog)
+struct SessionSettings {
+  // Arquivo em que a sessão é gravada ao fechar a janela
+  std::string recordPath;
+  // Sessão reproduzida em tempo real no lugar do teclado
+  std::string replayPath;
+  // Arquivo de telemetria (TelemetryWriter), gravado durante a sessão
+  std::string telemetryPath;
+  // Paciente cujo histórico (SessionStore) é mostrado e recebe a sessão ao
+  // fechar a janela, também gravado na telemetria; vazio desliga o histórico
+  std::string patient;
+  std::string storePath{"pinball.pbss"};
+};
+
 class Window final : public abcg::OpenGLWindow {
 public:
   ~Window() = default;
 
+  void setSessionSettings(SessionSettings settings) {
+    m_sessionSettings = std::move(settings);
+  }
+  // Executa a simulação em uma thread própria (SimulationThread), em vez de
+  // avançá-la em onUpdate; deve ser chamada antes de onCreate
+  void setThreadedSimulation(bool enabled) { m_threadedSimulation = enabled; }
+  // Frequência da física, em passos por segundo. Como o desenho é
+  // interpolado entre os passos, uma frequência menor que a da tela economiza
+  // CPU sem que o movimento trave; deve ser chamada antes de onCreate
+  void setTickRate(double tickRate) { m_tickRate = tickRate; }
+
+  // Programa de cor sólida da mesa e dos flippers; cor e transformação vêm
+  // do bloco de uniforms Object (ObjectUniforms)
   GLuint m_program{};
-  GLint m_colorLoc{};
-  GLint m_translateLoc{};
-  GLint m_scaleLoc{};
-  GLint m_rotateLoc{};
-  GLuint m_VAO{};
-
-  float m_gameScale{0.15f};
-  bool m_gameStarted{false};
-
-  struct Ball {
-    glm::vec2 position{};
-    glm::vec2 velocity{};
-    float radius{};
-  };
 
-  Ball m_ball;
+  // Chamadas de desenho do frame, gravadas pelas rotinas de Render e
+  // executadas, ordenadas por estado, por DrawList::flush
+  DrawList m_drawList;
+
+  // Geometria enviada uma única vez por Render::createMeshes: o quadrado do
+  // círculo de raio unitário (bolas e obstáculos), os dois flippers e a mesa
+  Mesh m_circleMesh;
+  Mesh m_flipperMesh;
+  Mesh m_tableMesh;
+  GLsizei m_tableLineVertices{};
+  GLsizei m_tableFanSize{};
+  GLsizei m_tableFanCount{};
+
+  // Bola, bolas da multibola e obstáculos são instâncias do círculo,
+  // desenhadas com uma única chamada por Render::renderBalls (e, na camada
+  // estática, por Render::renderObstacles). m_circleInstances é o espaço em
+  // que as instâncias são montadas antes de irem para m_drawList
+  GLuint m_circleProgram{};
+  std::vector<CircleInstance> m_circleInstances;
+
+  // Fundo, mesa e obstáculos, desenhados em uma textura por
+  // Render::renderStaticLayer e copiados para a tela com um único quadrado
+  GLuint m_layerProgram{};
+  Mesh m_screenQuadMesh;
+  StaticLayer m_staticLayer;
+  glm::ivec2 m_viewportSize{};
+
+  // Partículas das colisões, emitidas por Render::emitParticles
+  abcg::OpenGLParticleSystem m_particles;
+
+  float m_gameScale{GAME_SCALE};
+
+  Simulation m_simulation;
+  // Estado desenhado no frame atual: o último snapshot publicado pela thread
+  // da simulação ou, sem ela, uma cópia feita no início de onPaint
+  SimulationSnapshot const *m_frame{&m_localFrame};
+  // Fração do passo entre as posições anterior e atual de m_frame em que o
+  // frame é desenhado
+  float m_frameInterpolation{1.0f};
 
 private:
-  std::vector<Obstacle> m_obstacles;
+  // Desenha o jogo fora da tela para o pinball_bench
+  friend class RenderBenchmark;
+
+  SessionSettings m_sessionSettings;
+  SessionLog m_session;
+  std::optional<SessionPlayer> m_player;
+
+  std::optional<double> m_tickRate;
+  bool m_threadedSimulation{false};
+  std::unique_ptr<SimulationThread> m_simulationThread;
+  SimulationSnapshot m_localFrame;
+
+  // Tempo de reação: estímulo quando a bola desenhada cruza a zona de
+  // disparo, resposta na entrada de flipper seguinte
+  TriggerZone m_triggerZone;
+  ReactionTimer m_reactionTimer;
+  glm::vec2 m_lastDrawnBall{};
+  // Tentativa cujo frame do estímulo ainda não foi exibido, segundo
+  // abcg::OpenGLFrameTimer
+  struct PendingStimulus {
+    std::size_t attempt{};
+    std::uint64_t frame{};
+  };
+  std::optional<PendingStimulus> m_pendingStimulus;
+
+  // Estado desenhado e entradas de cada frame, gravados em segundo plano
+  std::unique_ptr<TelemetryWriter> m_telemetry;
+
+  // Sessões do paciente no período mostrado pela janela de progresso, e a
+  // mediana do tempo de reação de cada uma, em ms
+  static constexpr std::chrono::days historyPeriod{90};
+  std::vector<SessionRecord> m_history;
+  std::vector<float> m_historyMedians;
+  SessionStore::Duration m_sessionStart{};
+
   void onCreate() override;
   void onUpdate() override;
   void onPaint() override;
+  void onPaintUI() override;
+  void onResize(glm::ivec2 const &size) override;
   void onDestroy() override;
   void onEvent(SDL_Event const &event) override;
 
-  void setupBall();
-  void setupFlippers();
-  void checkCollisions();
-  void checkWallCollision();
-  void checkBottomWallCollision();
-  void checkCollisionWithObstacles();
+  void applyInput(Simulation::Input input, std::uint32_t timestamp);
+  // Avança a simulação, ou a reprodução da sessão, pelo tempo decorrido
+  void advanceSimulation(Simulation &simulation, double elapsed);
+  void recordInput(Simulation &simulation, Simulation::Input input,
+                   std::uint32_t timestamp,
+                   SimulationSnapshot::Clock::time_point time);
+  void recordTelemetryFrame(SimulationSnapshot::Clock::time_point now);
+  void stopTelemetry();
+  void updateFrame();
+  void collectCollisionEvents();
+  void detectStimulus(SimulationSnapshot::Clock::time_point now);
+  void resolveStimulusDisplay();
+  // Grava na telemetria o estímulo pendente, com a exibição estimada ou não
+  void recordPendingStimulus();
+  void recordResponse(SimulationSnapshot::Clock::time_point time);
+  void printReactionSummary() const;
+  void loadHistory();
+  void saveSession();
 };
 
 #endif